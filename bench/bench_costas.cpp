@@ -0,0 +1,61 @@
+// Costas sync scoring over one slot with every kernel the CPU runs, against
+// the scalar reference, at the 12 kHz spectrogram size (osr 4 x 2).
+#include "dsp/costas_kernel.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+int main() {
+  constexpr int kSteps = 372;   // 15 s in 40 ms steps
+  constexpr int kFosr = 2;
+  constexpr int kBins = 960 - 8; // tone bins with room for 8 tones
+  constexpr int kStarts = 125;   // candidate starts, -2 s .. +3 s
+  constexpr int kIters = 20;
+  std::vector<float> norm(static_cast<size_t>(kSteps) * kFosr * (kBins + 8));
+  std::vector<float> tones8(norm.size());
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<float> u(0.0f, 2.0f);
+  for (size_t i = 0; i < norm.size(); ++i) {
+    norm[i] = u(rng);
+    tones8[i] = 8.0f * u(rng);
+  }
+  auto row = [&](std::vector<float> &v, int step, int sub) {
+    return &v[(static_cast<size_t>(step) * kFosr + sub) * (kBins + 8)];
+  };
+  std::vector<float> score(static_cast<size_t>(kStarts) * kFosr * kBins);
+
+  auto run = [&](auto kernel) {
+    const float *sync_rows[21];
+    const float *all_rows[21];
+    auto t0 = std::chrono::steady_clock::now();
+    for (int it = 0; it < kIters; ++it) {
+      for (int t = 0; t < kStarts; ++t) {
+        for (int sub = 0; sub < kFosr; ++sub) {
+          int rows = 0;
+          for (int start : {0, 36, 72}) {
+            for (int i = 0; i < 7; ++i) {
+              int step = t + (start + i) * 4;
+              sync_rows[rows] = row(norm, step, sub) + (i * 3) % 7;
+              all_rows[rows++] = row(tones8, step, sub);
+            }
+          }
+          kernel(sync_rows, all_rows, rows, kBins,
+                 &score[(static_cast<size_t>(t) * kFosr + sub) * kBins]);
+        }
+      }
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(t1 - t0).count() / kIters;
+  };
+  const double cells = static_cast<double>(kStarts) * kFosr * kBins;
+  const double scalar = run(hf::costas_score_scalar);
+  std::printf("dispatching to %s\n", hf::costas_kernel_name());
+  for (const auto &kernel : hf::costas_kernels()) {
+    double sec = run(kernel.fn);
+    std::printf("%-7s %7.2f ms per slot (%.2f ns per cell, %.1fx)\n",
+                kernel.name, 1e3 * sec, 1e9 * sec / cells, scalar / sec);
+  }
+  return 0;
+}
@@ -0,0 +1,132 @@
+// Slot spectrogram storage: float vs 8-bit log power. Times sync and demod
+// over one 12 kHz slot with 20 FT8 signals and counts last-level cache
+// misses where perf counters are available.
+#include "dsp/demod.hpp"
+#include "dsp/encode.hpp"
+#include "dsp/spectrogram.hpp"
+#include "dsp/sync.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+// Hardware cache-miss counter for this thread; reads -1 if unavailable.
+class CacheMisses {
+public:
+  CacheMisses() {
+#if defined(__linux__)
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    fd_ = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+  }
+  ~CacheMisses() {
+#if defined(__linux__)
+    if (fd_ >= 0)
+      close(fd_);
+#endif
+  }
+  void start() {
+#if defined(__linux__)
+    if (fd_ >= 0) {
+      ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+      ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+  }
+  long long stop() {
+    long long count = -1;
+#if defined(__linux__)
+    if (fd_ >= 0) {
+      ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+      if (read(fd_, &count, sizeof(count)) != sizeof(count))
+        count = -1;
+    }
+#endif
+    return count;
+  }
+
+private:
+  int fd_{-1};
+};
+} // namespace
+
+int main() {
+  constexpr uint32_t kRate = 12000;
+  constexpr int kIters = 10;
+  std::vector<std::complex<float>> frame(15 * kRate);
+  std::mt19937 rng(1);
+  std::normal_distribution<float> g(0.0f, 0.1f);
+  for (auto &s : frame)
+    s = {g(rng), g(rng)};
+  hf::FT8Synthesizer synth(kRate);
+  std::vector<std::complex<float>> wave(synth.num_samples());
+  for (int i = 0; i < 20; ++i) {
+    std::array<uint8_t, 10> payload{};
+    for (int k = 0; k < 9; ++k)
+      payload[k] = static_cast<uint8_t>(rng());
+    payload[9] = 0;
+    synth.synth(hf::ft8_encode(payload), 300.0f + 130.0f * i, wave.data());
+    const size_t start = kRate / 2 + 240 * i;
+    for (size_t k = 0; k < wave.size() && start + k < frame.size(); ++k)
+      frame[start + k] += 0.05f * wave[k];
+  }
+
+  hf::SyncDetector sync(kRate);
+  sync.set_min_score(2.5f);
+  hf::FSK8Demod demod(kRate);
+  CacheMisses misses;
+  auto run = [&](hf::Spectrogram::Storage storage, const char *name) {
+    hf::Spectrogram spec(kRate, 4, 2);
+    spec.set_storage(storage);
+    spec.compute(frame);
+    std::vector<hf::SyncCandidate> cands;
+    hf::DemodulatedSignal sig;
+    double sync_sec = 0.0;
+    double demod_sec = 0.0;
+    long long sync_miss = 0;
+    long long demod_miss = 0;
+    cands = sync.detect(spec); // warm up
+    for (int it = 0; it < kIters; ++it) {
+      misses.start();
+      auto t0 = std::chrono::steady_clock::now();
+      cands = sync.detect(spec);
+      auto t1 = std::chrono::steady_clock::now();
+      sync_miss += misses.stop();
+      misses.start();
+      for (const auto &c : cands)
+        demod.demodulate(spec, c, sig);
+      auto t2 = std::chrono::steady_clock::now();
+      demod_miss += misses.stop();
+      sync_sec += std::chrono::duration<double>(t1 - t0).count();
+      demod_sec += std::chrono::duration<double>(t2 - t1).count();
+    }
+    std::printf("%-6s %6.2f MB  sync %7.2f ms %9lld misses  demod %zu "
+                "x %5.1f us %9lld misses\n",
+                name, spec.bytes() / 1e6, 1e3 * sync_sec / kIters,
+                sync_miss < 0 ? -1 : sync_miss / kIters, cands.size(),
+                cands.empty() ? 0.0 : 1e6 * demod_sec / kIters / cands.size(),
+                demod_miss < 0 ? -1 : demod_miss / kIters);
+  };
+  std::printf("per slot, %d runs (misses -1 = no perf counters)\n", kIters);
+  run(hf::Spectrogram::Storage::Float, "float");
+  run(hf::Spectrogram::Storage::Log8, "log8");
+  return 0;
+}
@@ -1,5 +1,9 @@
 #pragma once
+#include <cstdint>
+#include <map>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace hf {
 
@@ -7,6 +11,34 @@ struct Config {
   std::string db_path = "decodes.db";
   int web_port = 8080;
   std::string log_level = "info";
+  int spectrogram_time_osr = 4; // time steps per symbol
+  int spectrogram_freq_osr = 2; // frequency sub-bins per 6.25 Hz tone
+  std::string spectrogram_storage = "float"; // float or log8
+  int spectrogram_stream_ms = 160; // live spectrogram update period, 0 = off
+  int decode_threads = 0;       // decoder worker threads, 0 = one per core
+  int sync_max_candidates = 200; // candidates decoded per pass, 0 = all
+  float sync_min_score = 2.5f;   // Costas tones over the other tones
+  std::string decode_input = "iq"; // iq or usb (real audio)
+  uint32_t decode_rate = 4000;   // sync/demod rate, 12000 = no decimation
+  std::pair<float, float> passband_hz{200.0f, 3000.0f}; // audio searched
+  std::map<std::string, std::pair<float, float>> band_passband_hz; // by preset
+  std::string ldpc_decoder = "bp"; // bp, sum_product, layered or min_sum
+  int ldpc_max_iters = 50;
+  int ldpc_stall_iters = 15;      // stop after this many without progress
+  int ldpc_hopeless_iter = 8;     // give up at this iteration if more than
+  int ldpc_hopeless_errors = 22;  // this many parity checks still fail
+  int osd_depth = 2;              // OSD fallback order, 0 = off
+  int subtract_passes = 2;       // decode passes on the residual, 0 = off
+  float decode_budget_sec = 8.0f; // time limit of a slot's final pass
+  std::string fft_planner = "measure"; // estimate, measure or patient
+  std::string fft_wisdom_path = "fftw_wisdom.dat"; // empty = no wisdom file
+  std::string source = "rtlsdr"; // "rtlsdr" or "file"
+  std::string replay_path;
+  std::string replay_format = "auto"; // auto, cu8, cf32, ci16, wav, sigmf
+  uint32_t replay_sample_rate = 240000; // raw IQ recordings only
+  bool replay_realtime = false;         // pace replay at the sample rate
+  int slot_wake_offset_ms = 0; // decode trigger delay after each UTC slot end
+  std::vector<float> early_decode_sec{12.0f}; // early pass offsets in a slot
 
   static Config load(const std::string &path);
 };
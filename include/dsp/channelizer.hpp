@@ -0,0 +1,54 @@
+#pragma once
+#include "dsp/decimator.hpp"
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+namespace hf {
+
+// Splits one wideband capture into several narrow baseband channels. Each
+// channel is a digital down-converter: an NCO shifts the channel to 0 Hz and
+// its own polyphase decimator chain low-passes and decimates it. For the
+// handful of watering holes on a band this costs far less than a full
+// FFT filter bank, and channels can sit at arbitrary offsets. Buffers are
+// sized at construction; process() does not allocate.
+class Channelizer {
+public:
+  Channelizer(const std::vector<DecimatorChain::Stage> &stages,
+              size_t num_channels);
+
+  // Shift applied to channel ch, in cycles per input sample: a signal at
+  // +offset * input_rate Hz ends up at 0 Hz. Resets the channel's filters.
+  void set_offset(size_t ch, double offset);
+  double offset(size_t ch) const { return channels_[ch].offset; }
+
+  // Process n input samples; out[ch] receives channel ch and must hold
+  // max_output(n) samples. Returns the number of samples per channel.
+  size_t process(const std::complex<float> *in, size_t n,
+                 std::complex<float> *const *out);
+  size_t max_output(size_t n) const {
+    return channels_.empty() ? 0 : channels_[0].decimator.max_output(n);
+  }
+
+  size_t num_channels() const { return channels_.size(); }
+  int factor() const {
+    return channels_.empty() ? 1 : channels_[0].decimator.factor();
+  }
+
+private:
+  static constexpr size_t kBlock = 4096;
+
+  struct Channel {
+    explicit Channel(const std::vector<DecimatorChain::Stage> &stages)
+        : decimator(stages) {}
+    DecimatorChain decimator;
+    double offset{};
+    std::complex<double> phase{1.0, 0.0};
+    std::complex<double> step{1.0, 0.0};
+  };
+
+  std::vector<Channel> channels_;
+  std::vector<std::complex<float>> mixed_;
+};
+
+} // namespace hf
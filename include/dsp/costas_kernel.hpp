@@ -0,0 +1,34 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+namespace hf {
+
+// Sync score of n adjacent frequency bins from the spectrogram rows of one
+// candidate start: sync_rows[r][k] is the noise-normalized power of the
+// Costas tone of row r at bin k, all_rows[r][k] the power of all 8 tones
+// starting there. score[k] = 7 * sum(sync) / (sum(all) - sum(sync)), or 0
+// where the denominator is not positive. Rows are summed in order, so all
+// kernels agree to rounding.
+void costas_score(const float *const *sync_rows, const float *const *all_rows,
+                  int rows, int n, float *score);
+
+// Portable reference; costas_score() picks the widest SIMD kernel the CPU
+// runs (AVX2 or SSE2 on x86, chosen at run time; NEON on ARM).
+void costas_score_scalar(const float *const *sync_rows,
+                         const float *const *all_rows, int rows, int n,
+                         float *score);
+
+// Name of the kernel costas_score() dispatches to.
+const char *costas_kernel_name();
+
+// Every kernel the CPU can run, widest first and ending with the scalar
+// reference; costas_score() uses the first. For tests and benchmarks.
+struct CostasKernel {
+  const char *name;
+  void (*fn)(const float *const *sync_rows, const float *const *all_rows,
+             int rows, int n, float *score);
+};
+std::vector<CostasKernel> costas_kernels();
+
+} // namespace hf
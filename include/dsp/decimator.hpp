@@ -0,0 +1,79 @@
+#pragma once
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+namespace hf {
+
+// Kaiser-windowed sinc low-pass taps. cutoff is the -6 dB point in cycles per
+// input sample (0..0.5); atten_db sets the stopband attenuation of the window.
+std::vector<float> design_lowpass(int num_taps, float cutoff,
+                                  float atten_db = 60.0f);
+
+// Polyphase FIR decimator for complex samples with real taps. Only every
+// factor-th output is computed, each as one dot product over the input
+// history, which is the polyphase decomposition with the commutator folded
+// into the input stride. Filter state is kept between calls.
+class FirDecimator {
+public:
+  // Design taps with cutoff at the output Nyquist frequency.
+  FirDecimator(int factor, int num_taps);
+  FirDecimator(int factor, const std::vector<float> &taps);
+
+  // Filter and decimate n input samples into out, which must hold at least
+  // max_output(n) samples. Returns the number of samples written.
+  size_t process(const std::complex<float> *in, size_t n,
+                 std::complex<float> *out);
+  size_t max_output(size_t n) const { return n / factor_ + 1; }
+  void reset();
+
+  int factor() const { return factor_; }
+  const std::vector<float> &taps() const { return taps_; }
+
+  // Name of the inner-loop kernel selected at compile time.
+  static const char *kernel_name();
+
+private:
+  static constexpr size_t kBlock = 4096; // input samples per inner pass
+
+  int factor_;
+  std::vector<float> taps_;    // prototype filter as designed
+  std::vector<float> kernel_;  // reversed, zero padded, each tap duplicated
+  size_t span_;                // padded tap count in complex samples
+  std::vector<std::complex<float>> hist_; // span_ - 1 history + kBlock
+  size_t next_{};              // hist_ index of the next output's newest input
+};
+
+// Cascade of decimators, e.g. 5 x 4 for 240 kHz -> 12 kHz. Intermediate
+// buffers are sized at construction so process() does not allocate.
+class DecimatorChain {
+public:
+  struct Stage {
+    int factor;
+    int num_taps;
+  };
+
+  explicit DecimatorChain(const std::vector<Stage> &stages);
+
+  // Split an overall factor into stages of at most 8, largest first. Early
+  // stages only need to protect the final passband and get short filters;
+  // the last stage sets the passband edge. plan(20) gives 5 x 4.
+  static std::vector<Stage> plan(int factor);
+
+  size_t process(const std::complex<float> *in, size_t n,
+                 std::complex<float> *out);
+  size_t max_output(size_t n) const { return n / factor_ + stages_.size(); }
+  void reset();
+
+  int factor() const { return factor_; }
+  const std::vector<FirDecimator> &stages() const { return stages_; }
+
+private:
+  static constexpr size_t kBlock = 4096;
+
+  std::vector<FirDecimator> stages_;
+  std::vector<std::vector<std::complex<float>>> scratch_;
+  int factor_{1};
+};
+
+} // namespace hf
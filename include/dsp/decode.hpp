@@ -1,5 +1,6 @@
 #pragma once
 #include "dsp/demod.hpp"
+#include "dsp/ldpc_common.hpp"
 #include <array>
 #include <string>
 #include <vector>
@@ -11,15 +12,61 @@ enum class Mode { FT8, JS8 };
 struct DecodedMessage {
   bool crc_ok;
   int ldpc_errors;
+  int ldpc_iterations;             // iterations run, -1 if not reported
+  int osd_order;                   // OSD order that found it, 0 = BP
   std::array<uint8_t, 10> payload; // first 77 bits packed MSB-first
   std::string text;                // decoded message text (FT8/JS8)
   Mode mode;                       // which mode produced the text
 };
 
+// LDPC(174,91) decoder core: belief propagation with bp_decode's flooding
+// schedule (default, batched across candidates), the flooding sum-product
+// ldpc_decode, layered_decode or the fixed-point minsum_decode.
+enum class LdpcAlgorithm { BeliefPropagation, SumProduct, Layered, MinSum };
+
 class LDPCDecoder {
 public:
+  void set_algorithm(LdpcAlgorithm a) { algorithm_ = a; }
+  LdpcAlgorithm algorithm() const { return algorithm_; }
+  // "bp", "sum_product", "layered" or "min_sum"; anything else selects bp.
+  static LdpcAlgorithm algorithm_from_string(const std::string &name);
+  // Iteration cap and early-stop rules (sum_product honours the cap only).
+  void set_limits(const LdpcLimits &limits) { limits_ = limits; }
+  const LdpcLimits &limits() const { return limits_; }
+
+  // Decode from 174 code-bit LLRs (> 0 favours 1; missing bits count as
+  // erasures).
+  DecodedMessage decode(const std::vector<float> &llrs,
+                        bool allow_js8 = true) const;
+  // Decode from hard tone decisions, each bit given LLR +-1.
   DecodedMessage decode(const std::vector<int> &tones,
                         bool allow_js8 = true) const;
+  // Decode count codewords of 174 LLRs together, one per SIMD lane with
+  // belief propagation (see bp_decode_batch); out[i] receives the result
+  // for llrs[i].
+  void decode(const float *const *llrs, size_t count, bool allow_js8,
+              DecodedMessage *out) const;
+  // As above with other iteration limits, e.g. a reduced effort when
+  // running late.
+  void decode(const float *const *llrs, size_t count, bool allow_js8,
+              DecodedMessage *out, const LdpcLimits &limits) const;
+  // Ordered-statistics decoding of 174 LLRs up to order depth (1 or 2),
+  // for codewords the decoders above could not decode (see osd_decode).
+  // A candidate that disagrees with too many hard decisions is rejected
+  // before the CRC check.
+  DecodedMessage decode_osd(const float *llrs, int depth,
+                            bool allow_js8 = true) const;
+
+private:
+  // One codeword of 174 LLRs with the selected algorithm.
+  DecodedMessage decode_one(const float *llrs, const LdpcLimits &limits,
+                            bool allow_js8) const;
+  // CRC check and unpacking of BP output.
+  DecodedMessage finish(const uint8_t *plain, int errors,
+                        bool allow_js8) const;
+
+  LdpcAlgorithm algorithm_{LdpcAlgorithm::BeliefPropagation};
+  LdpcLimits limits_;
 };
 
 // Expose payload decoding helpers for unit tests
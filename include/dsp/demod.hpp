@@ -1,4 +1,5 @@
 #pragma once
+#include "dsp/spectrogram.hpp"
 #include "dsp/sync.hpp"
 #include <complex>
 #include <cstdint>
@@ -10,14 +11,25 @@ struct DemodulatedSignal {
   float freq_hz;  // refined frequency
   float time_sec; // refined time offset
   float snr_db;   // SNR referenced to 2.5 kHz noise BW
-  std::vector<int> tones; // 79 symbols
+  std::vector<int> tones; // 79 symbols (fewer if the frame is cut short)
+  std::vector<float> llrs; // 174 code bits; > 0 favours 1, 0 = erased
 };
 
 class FSK8Demod {
 public:
   explicit FSK8Demod(uint32_t sample_rate = 12000);
+  // Demodulate straight from samples when no spectrogram is at hand; tone
+  // powers come from a Goertzel bank (see ToneBank) built for this one
+  // candidate. The engine demodulates from its spectrogram instead.
   DemodulatedSignal demodulate(const std::vector<std::complex<float>> &frame,
                                const SyncCandidate &cand) const;
+  // Demodulate from a shared spectrogram; refinement is limited to the
+  // spectrogram's time and frequency grid.
+  DemodulatedSignal demodulate(const Spectrogram &spec,
+                               const SyncCandidate &cand) const;
+  // Same, reusing the storage already held by out.
+  void demodulate(const Spectrogram &spec, const SyncCandidate &cand,
+                  DemodulatedSignal &out) const;
 
 private:
   uint32_t sample_rate_;
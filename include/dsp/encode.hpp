@@ -0,0 +1,35 @@
+#pragma once
+#include <array>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace hf {
+
+// Channel tones of an FT8 transmission: CRC-14 and LDPC(174,91) parity are
+// added to the 77-bit payload (packed MSB-first), code bits are Gray mapped
+// three per tone and Costas blocks are placed at symbols 0, 36 and 72.
+std::array<uint8_t, 79> ft8_encode(const std::array<uint8_t, 10> &payload);
+
+// Continuous-phase GFSK (BT 2) waveform of 79 FT8 tones at unit amplitude,
+// the same shaping WSJT-X transmits, so it can be fitted to and subtracted
+// from a received slot.
+class FT8Synthesizer {
+public:
+  explicit FT8Synthesizer(uint32_t sample_rate = 12000);
+
+  int symbol_len() const { return symbol_len_; }
+  size_t num_samples() const { return static_cast<size_t>(79) * symbol_len_; }
+
+  // Write num_samples() complex baseband samples with tone 0 at freq_hz.
+  void synth(const std::array<uint8_t, 79> &tones, float freq_hz,
+             std::complex<float> *out) const;
+
+private:
+  uint32_t sample_rate_;
+  int symbol_len_;
+  std::vector<float> pulse_; // frequency pulse spanning three symbols
+};
+
+} // namespace hf
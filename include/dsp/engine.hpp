@@ -1,9 +1,19 @@
 #pragma once
 #include "dsp/sync.hpp"
 #include "dsp/demod.hpp"
+#include "dsp/decimator.hpp"
 #include "dsp/decode.hpp"
+#include "dsp/spectrogram.hpp"
+#include "dsp/subtract.hpp"
+#include "thread_pool.hpp"
+#include <array>
+#include <chrono>
 #include <complex>
+#include <functional>
+#include <memory>
+#include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace hf {
@@ -15,23 +25,188 @@ struct DecodedSignal {
   Mode mode;
   bool crc_ok;
   int ldpc_errors;
+  int ldpc_iterations; // -1 if the LDPC decoder does not report it
   std::string text;
+  std::array<uint8_t, 10> payload; // 77 message bits, for re-encoding
+};
+
+// Work done on a slot over all its passes.
+struct SlotStats {
+  size_t candidates{}; // sync candidates scheduled for decoding
+  size_t skipped{};    // left undecoded at the deadline
+  size_t reduced{};    // decoded with reduced LDPC effort and no OSD
+  int residual_passes{};
 };
 
 class DecodeEngine {
 public:
+  // Decode state of one slot, carried from pass to pass.
+  struct SlotState {
+    SlotState() = default;
+    explicit SlotState(Spectrogram s) : spec(std::move(s)) {}
+
+    Spectrogram spec;
+    std::vector<DecodedSignal> reported; // everything returned so far
+    bool started{false};
+    std::vector<std::complex<float>> residual; // frame minus decodes
+    std::vector<float> audio_residual;         // same for audio input
+    SlotStats stats;
+    float low_hz{};  // audio passband searched for signals
+    float high_hz{};
+    // Below the input rate (see set_decode_rate): the slot shifted by
+    // -center_hz and decimated, built up pass by pass.
+    float center_hz{};
+    float delay_sec{}; // group delay of the decimation filter
+    std::optional<FirDecimator> decimator;
+    std::complex<double> nco{1.0, 0.0};
+    size_t consumed{}; // input samples decimated so far
+    size_t produced{};
+    std::vector<std::complex<float>> baseband;
+  };
+
+  // time_osr/freq_osr set the oversampling of the per-frame spectrogram
+  // shared by sync and demod. Candidates are demodulated and decoded on a
+  // pool of threads workers (0 = one per core).
   explicit DecodeEngine(uint32_t sample_rate = 12000,
-                        bool enable_js8 = true);
+                        bool enable_js8 = true, int time_osr = 4,
+                        int freq_osr = 2, size_t threads = 0);
+  // Single full pass over a complete slot.
   std::vector<DecodedSignal>
   process(const std::vector<std::complex<float>> &frame) const;
+  // One pass over the first `available` samples of a slot frame (the rest
+  // of the frame is ignored). Spectrogram steps computed by earlier passes
+  // on the same state are reused, candidates on top of an earlier decode
+  // are skipped and only messages not reported before are returned. Early
+  // passes report CRC-valid messages only. The final pass then subtracts
+  // the FT8 signals decoded so far and searches the residual again (see
+  // set_subtraction_passes).
+  //
+  // Each pass runs against a deadline (see set_time_budget). Candidates
+  // are decoded in descending sync score; once the rest would not fit at
+  // the cost measured so far, LDPC runs with half the iterations and
+  // without OSD, no subtraction pass follows, and candidates still queued
+  // at the deadline are skipped. state.stats counts what was cut.
+  std::vector<DecodedSignal>
+  process(const std::vector<std::complex<float>> &frame, size_t available,
+          bool final, SlotState &state) const;
+  // Candidates are kept between low_hz and high_hz audio.
+  SlotState begin_slot(float low_hz = 200.0f, float high_hz = 3000.0f) const;
+  // Same, restarting a finished state in place so the next slot reuses its
+  // buffers.
+  void begin_slot(float low_hz, float high_hz, SlotState &state) const;
+  // The same for real audio, e.g. USB audio (see UsbDemod) or a mono
+  // recording. The spectrogram takes real-to-complex FFTs and audio is
+  // decoded at the input rate whatever set_decode_rate says.
+  std::vector<DecodedSignal> process(const std::vector<float> &audio) const;
+  std::vector<DecodedSignal> process(const std::vector<float> &audio,
+                                     size_t available, bool final,
+                                     SlotState &state) const;
+
+  // Bring the slot's spectrogram up to the first `available` samples
+  // without decoding, e.g. while the slot is still being captured, so the
+  // passes that follow find it ready. Returns the samples it now covers at
+  // the decode rate. process() calls this first; audio and IQ input must
+  // not be mixed within a slot.
+  size_t extend(const std::vector<std::complex<float>> &frame,
+                size_t available, SlotState &state) const;
+  size_t extend(const std::vector<float> &audio, size_t available,
+                SlotState &state) const;
+
+  // Rate sync, demod and subtraction run at. Below the input rate each
+  // slot is shifted to centre its passband on 0 Hz and decimated by an
+  // integer factor, e.g. to 4000 or 3000 Hz from 12 kHz, so every FFT
+  // shrinks by that factor. The passband must fit the new rate with some
+  // room for the filter skirts (about 2.8 kHz at 4 kHz, 2.2 kHz at 3 kHz).
+  // Returns false, leaving the rate unchanged, unless rate divides the
+  // input rate.
+  bool set_decode_rate(uint32_t rate);
+  uint32_t decode_rate() const { return sample_rate_ / decim_; }
+
+  // Build the FFT plans slots will need at the current settings, for IQ or
+  // (audio) real input, rather than in the first slot; call before saving
+  // FFTW wisdom so it holds them.
+  void prepare_plans(bool audio) const;
+
+  // Seconds into the slot at which early passes run on the samples
+  // captured so far, ahead of the final pass on the full slot.
+  void set_early_passes(std::vector<float> offsets_sec);
+  const std::vector<float> &early_passes() const { return early_passes_; }
+
+  // Cap on sync candidates demodulated per pass, and the minimum
+  // normalized sync score (see SyncDetector).
+  void set_max_candidates(size_t n) { sync_.set_max_candidates(n); }
+  void set_min_sync_score(float s) { sync_.set_min_score(s); }
+
+  // Extra decode passes on the residual after subtracting decoded signals;
+  // a further pass is skipped if the previous one suggests it would not
+  // fit the time budget.
+  void set_subtraction_passes(int n) { subtraction_passes_ = n; }
+  // Time budget in seconds of the final pass of a slot, including OSD and
+  // subtraction passes. An early pass has until the next pass is due.
+  void set_time_budget(float sec) { time_budget_sec_ = sec; }
+  // Clock deadlines are measured on, steady_clock by default; tests put in
+  // one they control. Called from the pool's workers.
+  using Clock = std::chrono::steady_clock;
+  void set_clock(std::function<Clock::time_point()> now) {
+    now_ = std::move(now);
+  }
+
+  // Storage of the slot spectrogram (see Spectrogram::Storage).
+  void set_spectrogram_storage(Spectrogram::Storage s) { storage_ = s; }
+
+  void set_ldpc_algorithm(LdpcAlgorithm a) { decoder_.set_algorithm(a); }
+  void set_ldpc_limits(const LdpcLimits &l) { decoder_.set_limits(l); }
+  // Ordered-statistics decoding of candidates LDPC fails on, up to this
+  // order (0 = off, 1 or 2). Within a pass the order drops, and OSD is
+  // finally skipped, once the candidates still queued would not fit the
+  // time left at the cost measured so far.
+  void set_osd_depth(int depth) { osd_depth_ = depth; }
+
   void set_js8_enabled(bool en) { js8_enabled_ = en; }
   bool js8_enabled() const { return js8_enabled_; }
 
 private:
+  // Sync, demodulate and decode one spectrogram, appending messages not
+  // reported before to state.reported and results. Returns false if the
+  // deadline forced reduced effort or skipped candidates.
+  bool decode_pass(const Spectrogram &spec, bool final, SlotState &state,
+                   std::chrono::steady_clock::time_point deadline,
+                   std::vector<DecodedSignal> &results) const;
+  // Subtract what the slot's passes decoded and search the residual
+  // again, up to subtraction_passes_ times while the deadline allows.
+  // state.residual (and for audio state.audio_residual) holds the slot.
+  void residual_passes(SlotState &state, size_t available,
+                       std::chrono::steady_clock::time_point start,
+                       std::chrono::steady_clock::time_point deadline,
+                       std::vector<DecodedSignal> &results) const;
+  // Seconds a pass on `available` samples may take.
+  float pass_budget(size_t available, bool final) const;
+  // Mix and decimate the first `available` input samples into
+  // state.baseband. Returns the number of baseband samples.
+  size_t decimate(const std::vector<std::complex<float>> &frame,
+                  size_t available, SlotState &state) const;
+  // Subtract reported FT8 signals [first, end) from state.residual.
+  void subtract(SlotState &state, size_t first, size_t available) const;
+
+  std::vector<float> early_passes_;
+  int subtraction_passes_{0};
+  float time_budget_sec_{8.0f};
+  std::function<Clock::time_point()> now_{Clock::now};
+  int osd_depth_{0};
   bool js8_enabled_;
+  uint32_t sample_rate_;
+  int decim_{1};
+  int time_osr_;
+  int freq_osr_;
+  Spectrogram::Storage storage_{Spectrogram::Storage::Float};
   SyncDetector sync_;
   FSK8Demod demod_;
   LDPCDecoder decoder_;
+  std::unique_ptr<ThreadPool> pool_;
+  // Per-worker demodulator output for one candidate batch, reused from
+  // batch to batch.
+  mutable std::vector<std::vector<DemodulatedSignal>> scratch_;
+  mutable SignalSubtractor subtractor_;
 };
 
 } // namespace hf
@@ -0,0 +1,76 @@
+#pragma once
+#include <complex>
+#include <cstddef>
+#include <fftw3.h>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace hf {
+
+// Allocator for FFT buffers: fftwf_malloc gives the SIMD alignment that
+// plans from FftPlans assume.
+template <typename T>
+struct FftwAllocator {
+  using value_type = T;
+  FftwAllocator() = default;
+  template <typename U>
+  FftwAllocator(const FftwAllocator<U> &) {}
+  T *allocate(size_t n) {
+    void *p = fftwf_malloc(n * sizeof(T));
+    if (!p)
+      throw std::bad_alloc();
+    return static_cast<T *>(p);
+  }
+  void deallocate(T *p, size_t) { fftwf_free(p); }
+  template <typename U>
+  bool operator==(const FftwAllocator<U> &) const { return true; }
+  template <typename U>
+  bool operator!=(const FftwAllocator<U> &) const { return false; }
+};
+
+using FftBuffer =
+    std::vector<std::complex<float>, FftwAllocator<std::complex<float>>>;
+using FftRealBuffer = std::vector<float, FftwAllocator<float>>;
+
+// Process-wide cache of FFTW plans keyed by size, direction and alignment.
+// FFTW's planner is not thread-safe, so planning is serialised here and
+// each plan is built once; executing a plan through fftwf_execute_dft is
+// thread-safe, so any thread may run a cached plan on its own buffers.
+// Plans are out-of-place; aligned plans need FftBuffer storage (or any
+// buffers with the same SIMD alignment).
+class FftPlans {
+public:
+  // Planner rigour for plans not yet built: FFTW_ESTIMATE, FFTW_MEASURE or
+  // FFTW_PATIENT. Measured plans take a while once but run faster.
+  static void set_rigor(unsigned flags);
+  static unsigned rigor_from_string(const std::string &name);
+
+  // Import/export accumulated wisdom so measured plans are not re-timed
+  // on every start. load_wisdom() returns false if the file is missing.
+  static bool load_wisdom(const std::string &path);
+  static bool save_wisdom(const std::string &path);
+
+  // Complex-to-complex plan of size n; sign is FFTW_FORWARD or
+  // FFTW_BACKWARD.
+  static fftwf_plan dft(int n, int sign, bool aligned = true);
+  // Real-to-complex plan of size n, producing the n / 2 + 1 bins of
+  // 0..fs/2 (the rest mirror them) for about half the work.
+  static fftwf_plan r2c(int n, bool aligned = true);
+
+  // Convenience: run plan on in/out, which must not alias.
+  static void execute(fftwf_plan plan, const std::complex<float> *in,
+                      std::complex<float> *out) {
+    fftwf_execute_dft(plan,
+                      reinterpret_cast<fftwf_complex *>(
+                          const_cast<std::complex<float> *>(in)),
+                      reinterpret_cast<fftwf_complex *>(out));
+  }
+  static void execute(fftwf_plan plan, const float *in,
+                      std::complex<float> *out) {
+    fftwf_execute_dft_r2c(plan, const_cast<float *>(in),
+                          reinterpret_cast<fftwf_complex *>(out));
+  }
+};
+
+} // namespace hf
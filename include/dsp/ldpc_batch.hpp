@@ -0,0 +1,28 @@
+#pragma once
+#include "dsp/ldpc_common.hpp"
+#include <cstddef>
+#include <cstdint>
+
+namespace hf {
+
+// Belief propagation for the FT8 LDPC(174,91) code with the schedule and
+// tanh/atanh approximations of bp_decode(), run on several codewords at
+// once: one codeword per SIMD lane, so the Tanner-graph traversal and
+// table lookups are shared by the whole batch. A lane that converges,
+// collapses to all zeros or meets a stop rule in limits is masked off with
+// its result frozen; the batch ends once every lane has finished.
+//
+// llrs[i] points at 174 LLRs of codeword i (> 0 favours 1).
+// plain[174 * i ...] receives its hard bits, errors[i] the fewest parity
+// errors seen (0 = valid codeword) and iterations[i] the iterations run
+// before it stopped. Any count is accepted; codewords are processed
+// bp_batch_lanes() at a time.
+void bp_decode_batch(const float *const *llrs, size_t count,
+                     const LdpcLimits &limits, uint8_t *plain, int *errors,
+                     int *iterations);
+
+// Codewords per batch and the name of the kernel selected at compile time.
+int bp_batch_lanes();
+const char *bp_batch_kernel_name();
+
+} // namespace hf
@@ -0,0 +1,64 @@
+#pragma once
+
+namespace hf {
+
+// Iteration limits shared by the LDPC decoders. Besides the hard cap, a
+// decode stops once the syndrome weight (failed parity checks) has not
+// improved for stall_iters iterations, and is abandoned as hopeless if
+// more than hopeless_errors checks still fail after hopeless_iter
+// iterations. Zero disables a rule.
+struct LdpcLimits {
+  int max_iters = 50;
+  int stall_iters = 15;
+  int hopeless_iter = 8;
+  int hopeless_errors = 22;
+};
+
+// Applies LdpcLimits to the syndrome weights of one codeword.
+class LdpcStopRule {
+public:
+  explicit LdpcStopRule(const LdpcLimits &limits) : limits_(limits) {}
+
+  // Parity errors after `iters` completed iterations. Returns true when
+  // decoding should stop: a valid codeword, a stall or a hopeless case.
+  bool update(int iters, int errors) {
+    if (errors < best_) {
+      best_ = errors;
+      best_at_ = iters;
+    }
+    if (errors == 0)
+      return true;
+    if (limits_.stall_iters > 0 && iters - best_at_ >= limits_.stall_iters)
+      return true;
+    return limits_.hopeless_errors > 0 && iters >= limits_.hopeless_iter &&
+           errors > limits_.hopeless_errors;
+  }
+
+  int best() const { return best_; }
+
+private:
+  LdpcLimits limits_;
+  int best_{83};
+  int best_at_{0};
+};
+
+// Rational tanh/atanh approximations used by bp_decode in ldpc.c.
+inline float ldpc_tanh(float x) {
+  if (x < -4.97f)
+    return -1.0f;
+  if (x > 4.97f)
+    return 1.0f;
+  float x2 = x * x;
+  float a = x * (945.0f + x2 * (105.0f + x2));
+  float b = 945.0f + x2 * (420.0f + x2 * 15.0f);
+  return a / b;
+}
+
+inline float ldpc_atanh(float x) {
+  float x2 = x * x;
+  float a = x * (945.0f + x2 * (-735.0f + x2 * 64.0f));
+  float b = 945.0f + x2 * (-1050.0f + x2 * 225.0f);
+  return a / b;
+}
+
+} // namespace hf
@@ -0,0 +1,20 @@
+#pragma once
+#include "dsp/ldpc_common.hpp"
+#include <cstdint>
+
+namespace hf {
+
+// Belief propagation for the FT8 LDPC(174,91) code with a layered
+// (check-row serial) schedule: each check row reads the posteriors already
+// updated by the rows before it in the same iteration, so information
+// crosses the graph faster than with the flooding schedule of bp_decode
+// and it converges in roughly a quarter fewer iterations. Same tanh/atanh
+// approximations as bp_decode.
+//
+// llrs are 174 values, > 0 favours 1. Returns the fewest parity errors
+// seen (0 = valid codeword), writes the hard decision of that iteration to
+// plain and the iterations run to *iterations.
+int layered_decode(const float *llrs, const LdpcLimits &limits,
+                   uint8_t *plain, int *iterations);
+
+} // namespace hf
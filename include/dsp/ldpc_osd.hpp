@@ -0,0 +1,22 @@
+#pragma once
+#include <cstdint>
+
+namespace hf {
+
+// Ordered-statistics decoding of the FT8 LDPC(174,91) code, the fallback
+// for codewords belief propagation cannot decode. The generator matrix
+// from kFTX_LDPC_generator is brought to systematic form on the 91 most
+// reliable independent bit positions by Gaussian elimination over rows
+// packed into 64-bit words. The codeword that agrees with the hard
+// decisions there is then re-encoded with every single (depth 1) or also
+// every pair (depth 2) of those positions flipped. The candidate with the
+// smallest sum of |LLR| over bits that disagree with the hard decisions
+// wins.
+//
+// llrs are 174 values, > 0 favours 1. Writes the chosen codeword to plain
+// (174 bits, one per byte) and returns how many of its bits disagree with
+// the hard decisions; a large count means the candidate is most likely
+// noise.
+int osd_decode(const float *llrs, int depth, uint8_t *plain);
+
+} // namespace hf
@@ -0,0 +1,111 @@
+#pragma once
+#include <array>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace hf {
+
+// Power spectrogram ("waterfall") of one 15 s frame, computed once and shared
+// by sync and demod. Each time step is a symbol-length FFT; steps advance by
+// symbol_len / time_osr samples and each 6.25 Hz tone bin is split into
+// freq_osr sub-bins by zero padding. Storage is laid out [step][freq_sub][bin]
+// so that tone bins of one sub-bin row are contiguous.
+class Spectrogram {
+public:
+  // Bins cover 0..fs/2 of the frame.
+  explicit Spectrogram(uint32_t sample_rate = 12000, int time_osr = 2,
+                       int freq_osr = 2);
+  // For a frame shifted down by center_hz and decimated to sample_rate:
+  // bins cover the whole complex band, center_hz - fs/2 .. center_hz + fs/2,
+  // and freq_hz() reports frequencies before the shift.
+  Spectrogram(uint32_t sample_rate, int time_osr, int freq_osr,
+              float center_hz);
+
+  // Recompute the spectrogram for a new frame. Real frames (USB audio)
+  // take a real-to-complex FFT, about half the work of a complex one.
+  void compute(const std::vector<std::complex<float>> &frame);
+  void compute(const std::vector<float> &frame);
+
+  // Incremental use for early decode passes: reset() starts a frame of up
+  // to max_samples samples, and each extend() adds the time steps that fit
+  // in the first `available` samples and were not computed before. Steps
+  // already computed are kept, so later passes only pay for new samples.
+  // Returns the number of new steps.
+  void reset(size_t max_samples);
+  int extend(const std::vector<std::complex<float>> &frame, size_t available);
+  int extend(const std::vector<float> &frame, size_t available);
+
+  uint32_t sample_rate() const { return sample_rate_; }
+  int symbol_len() const { return symbol_len_; }
+  int time_osr() const { return time_osr_; }
+  int freq_osr() const { return freq_osr_; }
+  int num_steps() const { return num_steps_; }
+  int num_bins() const { return num_bins_; }
+  bool empty() const { return num_steps_ == 0; }
+
+  // Seconds between time steps and Hz between tone bins.
+  float step_sec() const {
+    return static_cast<float>(symbol_len_) / time_osr_ / sample_rate_;
+  }
+  float bin_hz() const {
+    return static_cast<float>(sample_rate_) / symbol_len_;
+  }
+  float time_sec(int step) const { return step * step_sec(); }
+  float freq_hz(int freq_sub, int bin) const {
+    return base_hz_ +
+           (bin + static_cast<float>(freq_sub) / freq_osr_) * bin_hz();
+  }
+
+  // Storage of the power values. Log8 keeps log power in 0.5 dB steps,
+  // one byte per value as in ft8_lib's waterfall: a quarter of the memory
+  // of Float, decoded through a table on read. Takes effect at the next
+  // reset() or compute().
+  enum class Storage { Float, Log8 };
+  void set_storage(Storage s) { storage_ = s; }
+  Storage storage() const { return storage_; }
+  static Storage storage_from_string(const std::string &name);
+  // Take over other's power buffers, so the next reset() reuses their
+  // memory instead of allocating.
+  void take_buffers(Spectrogram &other);
+  // Memory held by the power values.
+  size_t bytes() const { return power_.size() * 4 + log_power_.size(); }
+
+  float power(int step, int freq_sub, int bin) const {
+    const size_t i = index(step, freq_sub) + bin;
+    return storage_ == Storage::Float ? power_[i]
+                                      : log_table_[log_power_[i]];
+  }
+  // Powers of bins [bin, bin + n) of one row.
+  void powers(int step, int freq_sub, int bin, int n, float *out) const;
+  // A whole row of num_bins() powers. Float storage returns the row in
+  // place; Log8 decodes it into scratch and returns that.
+  const float *row(int step, int freq_sub, float *scratch) const;
+
+private:
+  template <typename T>
+  int extend_frame(const std::vector<T> &frame, size_t available);
+  size_t index(int step, int freq_sub) const {
+    return (static_cast<size_t>(step) * freq_osr_ + freq_sub) * num_bins_;
+  }
+
+  uint32_t sample_rate_;
+  int symbol_len_;
+  int time_osr_;
+  int freq_osr_;
+  int num_steps_{};     // steps computed so far
+  int max_steps_{};     // steps that fit in the frame being built
+  int num_bins_;
+  bool two_sided_{false};
+  float base_hz_{0.0f}; // frequency of bin 0
+  Storage storage_{Storage::Float};
+  std::vector<float> power_;
+  std::vector<uint8_t> log_power_;
+  float log_ref_;                    // power of a full-scale tone
+  std::array<float, 256> log_table_; // Log8 code to power
+
+};
+
+} // namespace hf
@@ -0,0 +1,37 @@
+#pragma once
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace hf {
+
+// Upper-sideband demodulator: turns a complex baseband whose 0 Hz is the
+// dial frequency into the real audio a USB receiver would produce, as
+// WSJT-X and other decoders expect. A complex band-pass (a low-pass moved
+// up to the middle of the audio band) removes everything below the dial
+// first, so taking the real part folds nothing into the audio.
+class UsbDemod {
+public:
+  explicit UsbDemod(uint32_t sample_rate = 12000, float low_hz = 200.0f,
+                    float high_hz = 3000.0f, int num_taps = 127);
+
+  // Demodulate n samples into out. The filter is centred on each sample,
+  // so the audio is not delayed; samples outside [0, n) count as zero.
+  void process(const std::complex<float> *in, size_t n, float *out) const;
+  void process(const std::vector<std::complex<float>> &in,
+               std::vector<float> &out) const;
+  // Only outputs [first, last) of the above, written to out[first, last),
+  // e.g. to demodulate a slot piece by piece as it arrives.
+  void process(const std::complex<float> *in, size_t n, size_t first,
+               size_t last, float *out) const;
+
+  // Samples of context either side that fully determine one output.
+  size_t half_span() const { return re_.size() / 2; }
+
+private:
+  std::vector<float> re_; // complex taps, real and imaginary parts
+  std::vector<float> im_;
+};
+
+} // namespace hf
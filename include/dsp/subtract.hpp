@@ -0,0 +1,43 @@
+#pragma once
+#include "dsp/encode.hpp"
+#include <array>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace hf {
+
+// Removes decoded FT8 signals from a slot so weaker signals underneath can
+// be found by another sync/demod/decode pass. The regenerated waveform is
+// fitted to the frame in time and frequency, then multiplied by a slowly
+// varying complex amplitude (the received signal times the conjugate
+// reference, low-pass filtered over about two symbols), which follows
+// fading and residual phase drift. Holds scratch buffers: one instance per
+// thread.
+class SignalSubtractor {
+public:
+  explicit SignalSubtractor(uint32_t sample_rate = 12000);
+
+  // Subtract the signal with these tones from frame[0, available).
+  // freq_hz (tone 0) and time_sec (start of symbol 0 relative to frame[0])
+  // are the demodulator's estimates. Returns false if the signal does not
+  // overlap the frame.
+  bool subtract(std::complex<float> *frame, size_t available,
+                const std::array<uint8_t, 79> &tones, float freq_hz,
+                float time_sec);
+
+private:
+  // Sum over symbols of the coherent per-symbol correlation power with the
+  // reference placed at sample t0, using every stride-th sample.
+  float score(const std::complex<float> *frame, size_t available, long t0,
+              int stride) const;
+
+  uint32_t sample_rate_;
+  FT8Synthesizer synth_;
+  std::vector<std::complex<float>> ref_;
+  std::vector<std::complex<double>> amp_, amp_prefix_;
+  std::vector<double> weight_, weight_prefix_;
+};
+
+} // namespace hf
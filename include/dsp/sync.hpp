@@ -1,4 +1,5 @@
 #pragma once
+#include "dsp/spectrogram.hpp"
 #include <complex>
 #include <cstdint>
 #include <vector>
@@ -7,20 +8,47 @@ namespace hf {
 
 struct SyncCandidate {
   float freq_hz;    // frequency relative to baseband center
-  float time_sec;   // time offset from start of frame
-  float metric;     // correlation strength
+  float time_sec;   // time offset from start of frame, < 0 if before it
+  float metric;     // sync score (Costas tone power / other tones)
+  int step{};       // spectrogram time step of symbol 0, may be < 0
+  int freq_sub{};   // spectrogram frequency sub-bin
+  int bin{};        // spectrogram tone bin of Costas tone 0
 };
 
+// Finds FT8 Costas sync in the spectrogram. Powers are first normalized by
+// the noise floor of their frequency bin. Each start step and fine
+// frequency, at the spectrogram's time and frequency oversampling, is
+// then scored by the power of the 21 Costas tones of the three sync
+// blocks (symbols 0, 36 and 72) against the other tones of those symbols.
+// Blocks outside the frame are left out, so a transmission whose first
+// block is faded or starts before the frame is still found. Only cells
+// that are local maxima over their 3x3 neighbourhood are kept, and non-
+// maximum suppression leaves one candidate per signal (within one symbol
+// and one tone of a stronger peak). Candidates are ranked by score.
 class SyncDetector {
 public:
   explicit SyncDetector(uint32_t sample_rate = 12000);
   std::vector<SyncCandidate>
   detect(const std::vector<std::complex<float>> &frame) const;
+  std::vector<SyncCandidate> detect(const std::vector<float> &audio) const;
+  std::vector<SyncCandidate> detect(const Spectrogram &spec) const;
+  // Only candidates between low_hz and high_hz, so peaks outside the band
+  // do not count against max_candidates.
+  std::vector<SyncCandidate> detect(const Spectrogram &spec, float low_hz,
+                                    float high_hz) const;
+
+  // Upper bound on candidates returned per call (0 = unlimited).
+  void set_max_candidates(size_t n) { max_candidates_ = n; }
+  size_t max_candidates() const { return max_candidates_; }
+  // Minimum score for a candidate; noise scores about 1.
+  void set_min_score(float s) { min_score_ = s; }
+  float min_score() const { return min_score_; }
 
 private:
   uint32_t sample_rate_;
   int symbol_len_;
+  size_t max_candidates_{200};
+  float min_score_{2.5f};
 };
 
 } // namespace hf
-
@@ -0,0 +1,40 @@
+#pragma once
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+namespace hf {
+
+// Bank of Goertzel filters giving the power of a few DFT bins of a
+// block_len-sample block without a full FFT. The demodulator only reads the
+// 8 tones of a candidate (plus neighbours while refining), so a bank is far
+// cheaper than a 1920-point FFT per symbol. Tones may belong to several
+// candidates; the state of all tones is updated in lockstep, lanes of
+// kLanes, so the inner loop vectorises across tones.
+class ToneBank {
+public:
+  static constexpr size_t kLanes = 8;
+
+  explicit ToneBank(int block_len);
+
+  // Tone frequencies in DFT bins of the block (fractional bins allowed).
+  void set_tones(const std::vector<float> &bins);
+  // count consecutive bins starting at first_bin.
+  void set_tones(int first_bin, int count);
+
+  // Power of each tone over x[0..block_len), scaled like |FFT bin|^2.
+  // out must hold size() values.
+  void energies(const std::complex<float> *x, float *out);
+
+  size_t size() const { return num_tones_; }
+  int block_len() const { return block_len_; }
+
+private:
+  int block_len_;
+  size_t num_tones_{};
+  // Per tone, padded to a multiple of kLanes: 2 cos(w), cos(w), sin(w).
+  std::vector<float> coef_, cos_, sin_;
+  std::vector<float> s1re_, s1im_, s2re_, s2im_; // filter state
+};
+
+} // namespace hf
@@ -0,0 +1,82 @@
+#pragma once
+#include "sample_source.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace hf {
+
+// Replays a recording through the same ingest path as live capture, so the
+// full pipeline can be benchmarked and regression-tested without a dongle.
+// Supported inputs: raw cu8 / cf32 / ci16 IQ, SigMF (.sigmf-meta or
+// .sigmf-data) and PCM16 / float WAV (mono audio or stereo I/Q). The input
+// rate must be an integer multiple of 12 kHz.
+class FileSource : public SampleSource {
+public:
+  enum class Format { Auto, CU8, CF32, CI16, Wav, SigMF };
+
+  struct Options {
+    std::string path;
+    Format format = Format::Auto;
+    uint32_t sample_rate = 240000; // raw IQ only; headers override it
+    bool realtime = false;         // pace at the sample rate
+    std::string label = "replay";  // band label stored with decodes
+  };
+
+  explicit FileSource(Options opts);
+  ~FileSource() override;
+
+  // Parse headers and prepare the ingest chain. Returns false on an
+  // unreadable or unsupported file.
+  bool open();
+  void close();
+
+  bool start() override;
+  void stop() override;
+
+  const IqIngest &ingest() const override { return *ingest_; }
+  bool wait_for(uint64_t seq) override;
+  void release(uint64_t seq) override;
+  bool realtime() const override { return opts_.realtime; }
+  bool exhausted() const override { return finished_; }
+  const char *channel_label(size_t) const override {
+    return opts_.label.c_str();
+  }
+
+  uint32_t input_rate() const { return input_rate_; }
+  // Sample format inside the file after header parsing.
+  Format sample_format() const { return sample_format_; }
+
+  // Format implied by a file extension, or by a config value such as "cu8".
+  static Format format_from_name(const std::string &name);
+  static Format format_from_string(const std::string &name);
+
+private:
+  bool parse_wav();
+  bool parse_sigmf(const std::string &meta_path);
+  void run();
+  size_t read_chunk(std::complex<float> *out, size_t max_samples);
+
+  Options opts_;
+  std::FILE *file_{};
+  Format sample_format_{Format::CU8};
+  int channels_{2};         // 1 = real audio, 2 = interleaved I/Q
+  uint32_t input_rate_{};
+  uint64_t data_bytes_left_{}; // bounded by the WAV data chunk
+  std::vector<uint8_t> raw_;
+
+  std::unique_ptr<IqIngest> ingest_;
+  std::thread worker_;
+  std::atomic<bool> running_{false};
+  std::atomic<bool> finished_{false};
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  uint64_t released_{};
+};
+
+} // namespace hf
@@ -0,0 +1,87 @@
+#pragma once
+#include <complex>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace hf {
+
+// Fixed set of slot-sized sample buffers handed from capture to the decoder.
+// Buffers are allocated once; acquire() and release never allocate, so the
+// steady-state capture path is heap-free. When every buffer is in flight
+// acquire() returns an empty handle and the caller drops the slot.
+class FramePool {
+public:
+  using Frame = std::vector<std::complex<float>>;
+
+  class Handle {
+  public:
+    Handle() = default;
+    Handle(Handle &&o) noexcept : pool_(o.pool_), index_(o.index_) {
+      o.pool_ = nullptr;
+    }
+    Handle &operator=(Handle &&o) noexcept {
+      if (this != &o) {
+        reset();
+        pool_ = o.pool_;
+        index_ = o.index_;
+        o.pool_ = nullptr;
+      }
+      return *this;
+    }
+    Handle(const Handle &) = delete;
+    Handle &operator=(const Handle &) = delete;
+    ~Handle() { reset(); }
+
+    explicit operator bool() const { return pool_ != nullptr; }
+    Frame &operator*() const { return pool_->frames_[index_]; }
+    Frame *operator->() const { return &pool_->frames_[index_]; }
+
+    // Return the buffer to the pool early.
+    void reset() {
+      if (pool_) {
+        pool_->release(index_);
+        pool_ = nullptr;
+      }
+    }
+
+  private:
+    friend class FramePool;
+    Handle(FramePool *pool, size_t index) : pool_(pool), index_(index) {}
+    FramePool *pool_{};
+    size_t index_{};
+  };
+
+  FramePool(size_t count, size_t frame_len)
+      : frames_(count, Frame(frame_len)) {
+    free_.reserve(count);
+    for (size_t i = count; i > 0; --i)
+      free_.push_back(i - 1);
+  }
+
+  Handle acquire() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (free_.empty())
+      return Handle();
+    size_t index = free_.back();
+    free_.pop_back();
+    return Handle(this, index);
+  }
+
+  size_t available() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return free_.size();
+  }
+
+private:
+  void release(size_t index) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_.push_back(index);
+  }
+
+  std::vector<Frame> frames_;
+  std::vector<size_t> free_;
+  mutable std::mutex mutex_;
+};
+
+} // namespace hf
@@ -0,0 +1,66 @@
+#pragma once
+#include "dsp/channelizer.hpp"
+#include "spsc_ring.hpp"
+#include <array>
+#include <atomic>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace hf {
+
+// Sample ingest stage: converts raw RTL-SDR IQ bytes, splits them into one
+// or more baseband channels (each low-pass filtered and decimated), and
+// appends each channel to its own lock-free ring. All channels share one
+// sequence numbering. All scratch space is sized at construction so the
+// push_*() and snapshot() paths never touch the heap. push_*() must be called
+// from a single producer thread.
+class IqIngest {
+public:
+  static constexpr size_t kMaxChannels = 8;
+
+  IqIngest(const std::vector<DecimatorChain::Stage> &stages,
+           size_t ring_capacity, size_t num_channels = 1);
+
+  // Interleaved unsigned 8-bit I/Q as delivered by librtlsdr.
+  void push_u8(const uint8_t *buf, size_t len);
+  // Complex samples at the input rate.
+  void push(const std::complex<float> *in, size_t n);
+
+  // Retune channel ch to offset cycles per input sample (see Channelizer).
+  // Safe to call from any thread; the producer applies it before its next
+  // push, without allocating.
+  void set_channel_offset(size_t ch, double offset);
+
+  // Total baseband samples produced so far on every channel.
+  uint64_t head() const { return rings_.back()->head(); }
+  const SpscRing<std::complex<float>> &ring(size_t ch = 0) const {
+    return *rings_[ch];
+  }
+  size_t num_channels() const { return rings_.size(); }
+  int decimation() const { return channelizer_.factor(); }
+
+  // Copy the latest n baseband samples of channel ch (oldest first) into
+  // out. Samples not yet captured or overwritten during the copy are zeroed;
+  // returns the number of overwritten samples.
+  size_t snapshot(std::complex<float> *out, size_t n, size_t ch = 0) const;
+
+private:
+  static constexpr size_t kChunk = 4096; // input samples per pass
+
+  void apply_offsets();
+  void emit(const std::complex<float> *in, size_t n);
+
+  Channelizer channelizer_;
+  std::vector<std::unique_ptr<SpscRing<std::complex<float>>>> rings_;
+  std::vector<std::complex<float>> iq_;
+  std::vector<std::vector<std::complex<float>>> down_;
+  std::vector<std::complex<float> *> down_ptrs_;
+  std::array<std::atomic<double>, kMaxChannels> pending_{};
+  std::atomic<uint32_t> pending_gen_{0};
+  uint32_t applied_gen_{0};
+};
+
+} // namespace hf
@@ -1,8 +1,7 @@
 #pragma once
+#include "sample_source.hpp"
 #include <atomic>
-#include <complex>
 #include <cstdint>
-#include <mutex>
 #include <string>
 #include <thread>
 #include <vector>
@@ -11,15 +10,10 @@ struct rtlsdr_dev; // forward declaration from librtlsdr
 
 namespace hf {
 
-struct BandPreset {
-  const char *name;
-  uint32_t center_freq_hz;
-};
-
-class RfInput {
+class RfInput : public SampleSource {
 public:
   RfInput();
-  ~RfInput();
+  ~RfInput() override;
 
   // Try to open an RTL-SDR starting from the given device index. If the
   // device is busy, subsequent indices up to five total attempts are tried.
@@ -31,21 +25,18 @@ public:
 
   // Set active band preset by index. Returns false on invalid index or
   // failure to retune the SDR.
-  bool set_band(size_t index);
-  size_t current_band() const { return current_preset_; }
+  bool set_band(size_t index) override;
+  size_t current_band() const override { return current_preset_; }
 
-  bool start();
-  void stop();
+  bool start() override;
+  void stop() override;
 
-  const std::vector<BandPreset> &presets() const { return presets_; }
-  const std::vector<std::complex<float>> &ring_buffer() const {
-    return ring_buffer_;
-  }
-  size_t ring_pos() const { return ring_pos_; }
+  const IqIngest &ingest() const override { return ingest_; }
+  bool wait_for(uint64_t seq) override;
+  bool clocked() const override { return true; }
 
-  // Return a copy of the current 15 s ring buffer starting at the
-  // most recent sample. Thread-safe snapshot for external consumers.
-  std::vector<std::complex<float>> snapshot() const;
+  const std::vector<BandPreset> &presets() const override { return presets_; }
+  const char *channel_label(size_t ch) const override;
 
 private:
   static void rtlsdr_callback(unsigned char *buf, uint32_t len, void *ctx);
@@ -55,15 +46,19 @@ private:
   std::thread worker_;
   std::atomic<bool> running_{false};
 
-  std::vector<std::complex<float>> ring_buffer_;
-  size_t ring_pos_{};
-  mutable std::mutex buffer_mutex_;
+  static constexpr uint32_t kDecimation = 20; // 240 kHz / 20 = 12 kHz
+
+  static constexpr size_t kBandChannels = 2; // channels per band preset
 
-  static constexpr uint32_t kBasebandRate = 12000; // 12 kHz
-  static constexpr uint32_t kDecimation = 20;      // 240 kHz / 20 = 12 kHz
+  // 240 kHz -> 48 kHz -> 12 kHz per channel; the second stage sets the
+  // ~5 kHz passband. Fed only by the librtlsdr callback thread; each ring
+  // holds two slots so a snapshot of the latest slot is not overwritten
+  // while it is copied.
+  IqIngest ingest_{DecimatorChain::plan(kDecimation), 2 * kSlotSamples,
+                   kBandChannels};
 
   std::vector<BandPreset> presets_;
-  size_t current_preset_{};
+  std::atomic<size_t> current_preset_{0};
 };
 
 } // namespace hf
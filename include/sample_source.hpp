@@ -0,0 +1,108 @@
+#pragma once
+#include "dsp/ssb.hpp"
+#include "iq_ingest.hpp"
+#include <atomic>
+#include <chrono>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace hf {
+
+struct ChannelPreset {
+  const char *label;     // stored with each decode, e.g. "40m FT8"
+  uint32_t dial_freq_hz; // USB dial frequency; 0 Hz of the channel baseband
+};
+
+struct BandPreset {
+  const char *name;
+  uint32_t center_freq_hz; // SDR tuning, kept clear of the channels' DC
+  std::vector<ChannelPreset> channels;
+};
+
+// Producer of 12 kHz complex baseband. Implementations push samples into an
+// IqIngest ring from their own thread; consumers address the stream by
+// sample sequence number and never block the producer.
+class SampleSource {
+public:
+  static constexpr uint32_t kBasebandRate = 12000; // 12 kHz
+  static constexpr size_t kSlotSamples = kBasebandRate * 15;
+
+  virtual ~SampleSource() = default;
+
+  virtual bool start() = 0;
+  virtual void stop() = 0;
+
+  virtual const IqIngest &ingest() const = 0;
+
+  // Block until at least seq baseband samples have been produced. Returns
+  // false if the source stopped or ran out of data first.
+  virtual bool wait_for(uint64_t seq) = 0;
+  // Consumer is done with all samples before seq. Sources that are not
+  // paced by a clock use this for flow control.
+  virtual void release(uint64_t seq) { (void)seq; }
+  // True when samples arrive at the sample rate (live hardware or paced
+  // replay); false when replaying as fast as the consumer keeps up.
+  virtual bool realtime() const { return true; }
+  // True once a finite source has delivered all of its samples.
+  virtual bool exhausted() const { return false; }
+
+  // True when samples are timestamped against the system clock as they
+  // arrive, so slots can be cut on UTC boundaries. Replayed recordings are
+  // cut into slots from their first sample instead.
+  virtual bool clocked() const { return false; }
+  // Sequence number of the baseband sample taken at time t (may be negative
+  // or beyond head()). Returns false until the producer has stamped the
+  // stream.
+  bool sample_at(std::chrono::system_clock::time_point t, int64_t &seq) const;
+
+  // Baseband channels produced in parallel from one capture.
+  size_t num_channels() const { return ingest().num_channels(); }
+  virtual const char *channel_label(size_t ch) const {
+    (void)ch;
+    return "unknown";
+  }
+
+  virtual const std::vector<BandPreset> &presets() const;
+  virtual size_t current_band() const { return 0; }
+  // Set active band preset by index. Returns false on invalid index or
+  // failure to retune.
+  virtual bool set_band(size_t index) {
+    (void)index;
+    return false;
+  }
+
+  // Copy baseband samples [start, start + out.size()) of channel ch into
+  // out. Returns the number of samples that were unavailable (overwritten
+  // ones at the front, not yet captured ones at the end); those are zeroed.
+  size_t read(uint64_t start, std::vector<std::complex<float>> &out,
+              size_t ch = 0) const;
+  size_t read(uint64_t start, std::complex<float> *out, size_t n,
+              size_t ch = 0) const;
+  // USB audio of the same samples, demodulated from channel ch with the
+  // filter primed on the samples either side (see UsbDemod).
+  size_t read_usb(uint64_t start, float *out, size_t n, const UsbDemod &usb,
+                  size_t ch = 0) const;
+
+  // Copy the most recent 15 s of baseband (oldest sample first) into out
+  // without blocking the producer. Returns the number of leading samples that
+  // were overwritten while copying; those are zeroed. Does not allocate when
+  // out already holds kSlotSamples elements.
+  size_t snapshot(std::vector<std::complex<float>> &out) const;
+  std::vector<std::complex<float>> snapshot() const;
+
+protected:
+  // Producer only: record that baseband sample head - 1 arrived at now.
+  // Arrival times include USB and buffering delay, so the earliest arrival
+  // seen over each minute anchors the stream; re-anchoring every minute
+  // follows the dongle's crystal error.
+  void stamp(uint64_t head, std::chrono::system_clock::time_point now);
+
+private:
+  std::atomic<int64_t> epoch_ns_{0}; // system time of sample 0; 0 = unknown
+  int64_t window_min_ns_{0};
+  uint64_t window_end_{0};
+};
+
+} // namespace hf
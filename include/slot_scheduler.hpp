@@ -0,0 +1,81 @@
+#pragma once
+#include "sample_source.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace hf {
+
+// Cuts a sample stream into consecutive 15 s slots. For clocked sources each
+// slot spans exactly one UTC period (:00, :15, :30, :45); the scheduler wakes
+// a configurable offset after the period ends, waits for its last sample and
+// records how late the hand-over was. Early passes hand over the start of
+// the current period at given offsets into it, ahead of the full slot, and
+// stream updates hand it over at a fixed period in between so the decoder
+// can build the spectrogram while the slot is still being captured.
+// Unclocked sources (replays) are cut from their first sample and get the
+// final pass only.
+class SlotScheduler {
+public:
+  static constexpr int kSlotSec = 15;
+
+  struct Slot {
+    uint64_t start_seq{}; // first baseband sample of the slot
+    std::time_t utc{};    // UTC start of the period; 0 when unclocked
+    double late_sec{};    // hand-over time past the scheduled wake time
+    size_t samples{};     // samples captured from start_seq on
+    bool final{true};     // full slot; otherwise an early pass
+    bool decode{true};    // false for a stream update, not to be decoded
+  };
+
+  SlotScheduler(SampleSource &source, std::chrono::milliseconds wake_offset,
+                std::vector<float> early_passes = {},
+                std::chrono::milliseconds stream_period = {});
+
+  // Block until the next complete slot is available. Periods the stream
+  // only partly covers are skipped. Returns false if the source stopped or
+  // ran out of samples, or once running is cleared.
+  bool next(Slot &slot, const std::atomic<bool> &running);
+
+  // End of the first period after `after` whose wake time is not before
+  // now, in seconds since the epoch.
+  static std::time_t next_boundary(std::chrono::system_clock::time_point now,
+                                   std::chrono::milliseconds wake_offset,
+                                   std::time_t after);
+
+  // Wall clock and sleep the schedule runs on; tests put in a clock they
+  // control and a sleep that advances it.
+  using Clock = std::chrono::system_clock;
+  void set_clock(std::function<Clock::time_point()> now,
+                 std::function<void(Clock::duration)> sleep) {
+    now_ = std::move(now);
+    sleep_ = std::move(sleep);
+  }
+
+private:
+  bool next_unclocked(Slot &slot);
+
+  // Hand-over before the end of a period.
+  struct Pass {
+    float sec;   // into the slot
+    bool decode; // early pass; otherwise a stream update
+  };
+
+  SampleSource &source_;
+  std::chrono::milliseconds wake_offset_;
+  std::vector<Pass> early_;   // early passes and stream updates, ascending
+  std::time_t end_{0};        // end of the period being handed out
+  size_t pass_{0};            // next pass of that period
+  int64_t start_seq_{-1};     // first sample of that period once known
+  bool started_{false};
+  uint64_t next_seq_{0};
+  std::function<Clock::time_point()> now_{Clock::now};
+  std::function<void(Clock::duration)> sleep_{
+      [](Clock::duration d) { std::this_thread::sleep_for(d); }};
+};
+
+} // namespace hf
@@ -0,0 +1,77 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace hf {
+
+// Single-producer ring buffer addressed by 64-bit sequence numbers. The
+// producer never waits: it overwrites the oldest data unconditionally. Readers
+// copy any window of recent items without locking and are told afterwards how
+// many of the copied items the producer overwrote while they were copying
+// (seqlock-style validation against the producer's claim counter).
+template <typename T>
+class SpscRing {
+public:
+  // Capacity is rounded up to a power of two so indices wrap with a mask.
+  explicit SpscRing(size_t min_capacity) {
+    size_t cap = 1;
+    while (cap < min_capacity)
+      cap <<= 1;
+    buf_.resize(cap);
+    mask_ = cap - 1;
+  }
+
+  size_t capacity() const { return buf_.size(); }
+
+  // Sequence number of the next item to be written, i.e. the total number
+  // of items written so far. Items [head() - capacity(), head()) are valid.
+  uint64_t head() const { return head_.load(std::memory_order_acquire); }
+
+  // Producer only. Wait-free; if n exceeds the capacity only the newest
+  // capacity() items are kept.
+  void write(const T *data, size_t n) {
+    uint64_t h = head_.load(std::memory_order_relaxed);
+    if (n > buf_.size()) {
+      h += n - buf_.size();
+      data += n - buf_.size();
+      n = buf_.size();
+    }
+    claim_.store(h + n, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    size_t idx = static_cast<size_t>(h) & mask_;
+    size_t first = std::min(n, buf_.size() - idx);
+    std::copy(data, data + first, buf_.begin() + idx);
+    std::copy(data + first, data + n, buf_.begin());
+    head_.store(h + n, std::memory_order_release);
+  }
+
+  // Copy n <= capacity() items starting at sequence number start into out.
+  // The caller should only request items below head(). Returns how many of
+  // the copied items were overwritten before or during the copy and must be
+  // treated as invalid (always a prefix of out); 0 means the copy is
+  // consistent.
+  size_t read(uint64_t start, T *out, size_t n) const {
+    n = std::min(n, buf_.size());
+    size_t idx = static_cast<size_t>(start) & mask_;
+    size_t first = std::min(n, buf_.size() - idx);
+    std::copy(buf_.begin() + idx, buf_.begin() + idx + first, out);
+    std::copy(buf_.begin(), buf_.begin() + (n - first), out + first);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t claimed = claim_.load(std::memory_order_relaxed);
+    uint64_t oldest = claimed > buf_.size() ? claimed - buf_.size() : 0;
+    if (oldest <= start)
+      return 0;
+    return static_cast<size_t>(std::min<uint64_t>(n, oldest - start));
+  }
+
+private:
+  std::vector<T> buf_;
+  size_t mask_;
+  alignas(64) std::atomic<uint64_t> claim_{0};
+  alignas(64) std::atomic<uint64_t> head_{0};
+};
+
+} // namespace hf
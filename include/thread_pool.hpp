@@ -0,0 +1,69 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace hf {
+
+// Persistent work-stealing pool. parallel_for() splits a range into chunks
+// and deals them round-robin onto per-worker deques; each worker drains its
+// own deque from the back and steals from the front of the others when it
+// runs dry, so uneven chunks still keep every core busy.
+class ThreadPool {
+public:
+  // Body of a parallel_for: handles [begin, end) on the worker with index
+  // worker in [0, size()). Use the index to pick per-worker scratch space.
+  using RangeFn = std::function<void(size_t begin, size_t end, size_t worker)>;
+
+  // num_threads == 0 uses one worker per hardware thread.
+  explicit ThreadPool(size_t num_threads = 0);
+  ~ThreadPool();
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  // Number of worker threads.
+  size_t size() const { return threads_.size(); }
+
+  // Run fn over [0, n) in chunks of at most grain items and block until
+  // every chunk has finished. Safe to call from several threads at once;
+  // a worker runs one chunk at a time, so per-worker scratch stays private.
+  void parallel_for(size_t n, size_t grain, const RangeFn &fn);
+
+private:
+  struct Batch {
+    size_t pending{0}; // chunks not finished, guarded by mutex
+    std::mutex mutex;
+    std::condition_variable done;
+  };
+  struct Task {
+    const RangeFn *fn;
+    size_t begin;
+    size_t end;
+    Batch *batch;
+  };
+  struct Queue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  bool pop(size_t self, Task &task);
+  bool steal(size_t self, Task &task);
+  void run(const Task &task, size_t worker);
+  void worker_loop(size_t self);
+
+  std::vector<std::unique_ptr<Queue>> queues_;
+  std::vector<std::thread> threads_;
+  std::mutex wake_mutex_;
+  std::condition_variable wake_;
+  std::atomic<size_t> queued_{0};
+  std::atomic<size_t> next_queue_{0};
+  bool stop_{false};
+};
+
+} // namespace hf
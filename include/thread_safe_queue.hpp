@@ -1,29 +1,47 @@
 #pragma once
+#include <algorithm>
 #include <condition_variable>
-#include <deque>
+#include <cstddef>
 #include <mutex>
+#include <utility>
+#include <vector>
 
 namespace hf {
 
+// Blocking FIFO between threads. Items live in a ring that only grows when
+// full, so a queue reserved for the most items ever in flight never
+// allocates on push.
 template <typename T>
 class ThreadSafeQueue {
 public:
+  void reserve(size_t capacity) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (capacity > ring_.size())
+      grow(capacity);
+  }
+
   void push(T value) {
     {
       std::lock_guard<std::mutex> lock(mutex_);
-      queue_.push_back(std::move(value));
+      if (size_ == ring_.size())
+        grow(std::max<size_t>(16, 2 * ring_.size()));
+      ring_[(head_ + size_) % ring_.size()] = std::move(value);
+      ++size_;
     }
     cv_.notify_one();
   }
 
   bool pop(T &value) {
     std::unique_lock<std::mutex> lock(mutex_);
-    cv_.wait(lock, [&] { return !queue_.empty() || stopped_; });
-    if (queue_.empty()) {
+    cv_.wait(lock, [&] { return size_ > 0 || stopped_; });
+    if (size_ == 0) {
       return false;
     }
-    value = std::move(queue_.front());
-    queue_.pop_front();
+    // Moved-from items stay in the ring; T must release what it holds
+    // when moved from (handles, vectors).
+    value = std::move(ring_[head_]);
+    head_ = (head_ + 1) % ring_.size();
+    --size_;
     return true;
   }
 
@@ -36,11 +54,21 @@ public:
   }
 
 private:
+  // Caller holds mutex_.
+  void grow(size_t capacity) {
+    std::vector<T> ring(capacity);
+    for (size_t i = 0; i < size_; ++i)
+      ring[i] = std::move(ring_[(head_ + i) % ring_.size()]);
+    ring_.swap(ring);
+    head_ = 0;
+  }
+
   std::mutex mutex_;
   std::condition_variable cv_;
-  std::deque<T> queue_;
+  std::vector<T> ring_;
+  size_t head_{0};
+  size_t size_{0};
   bool stopped_{false};
 };
 
 } // namespace hf
-
@@ -1,8 +1,9 @@
 #pragma once
 #include "data_store.hpp"
-#include "rf_input.hpp"
+#include "sample_source.hpp"
 #include "dsp/engine.hpp"
 #include <atomic>
+#include <ctime>
 #include <memory>
 #include <string>
 
@@ -20,11 +21,12 @@ class AudioHandler;
 
 class WebServer {
 public:
-  WebServer(DataStore &db, RfInput &rf, DecodeEngine &engine,
+  WebServer(DataStore &db, SampleSource &rf, DecodeEngine &engine,
             std::atomic<std::time_t> &last_capture,
             std::atomic<std::time_t> &last_decode,
-            std::atomic<size_t> &last_count, const std::string &doc_root,
-            int port = 8080);
+            std::atomic<size_t> &last_count,
+            std::atomic<long> &last_trigger_late_ms,
+            const std::string &doc_root, int port = 8080);
   ~WebServer();
 
 private:
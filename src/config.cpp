@@ -12,6 +12,15 @@ std::string trim(const std::string &s) {
   auto end = s.find_last_not_of(" \t\r\n");
   return s.substr(start, end - start + 1);
 }
+
+// "low,high" in Hz.
+std::pair<float, float> parse_range(const std::string &s) {
+  auto comma = s.find(',');
+  if (comma == std::string::npos)
+    return {0.0f, std::stof(s)};
+  return {std::stof(trim(s.substr(0, comma))),
+          std::stof(trim(s.substr(comma + 1)))};
+}
 } // namespace
 
 Config Config::load(const std::string &path) {
@@ -38,6 +47,67 @@ Config Config::load(const std::string &path) {
       cfg.web_port = std::stoi(value);
     } else if (key == "log_level") {
       cfg.log_level = value;
+    } else if (key == "spectrogram_time_osr") {
+      cfg.spectrogram_time_osr = std::stoi(value);
+    } else if (key == "spectrogram_freq_osr") {
+      cfg.spectrogram_freq_osr = std::stoi(value);
+    } else if (key == "spectrogram_storage") {
+      cfg.spectrogram_storage = value;
+    } else if (key == "spectrogram_stream_ms") {
+      cfg.spectrogram_stream_ms = std::stoi(value);
+    } else if (key == "decode_threads") {
+      cfg.decode_threads = std::stoi(value);
+    } else if (key == "sync_max_candidates") {
+      cfg.sync_max_candidates = std::stoi(value);
+    } else if (key == "sync_min_score") {
+      cfg.sync_min_score = std::stof(value);
+    } else if (key == "decode_input") {
+      cfg.decode_input = value;
+    } else if (key == "decode_rate") {
+      cfg.decode_rate = static_cast<uint32_t>(std::stoul(value));
+    } else if (key == "passband_hz") {
+      cfg.passband_hz = parse_range(value);
+    } else if (key.rfind("passband_hz.", 0) == 0) {
+      cfg.band_passband_hz[key.substr(12)] = parse_range(value);
+    } else if (key == "ldpc_decoder") {
+      cfg.ldpc_decoder = value;
+    } else if (key == "ldpc_max_iters") {
+      cfg.ldpc_max_iters = std::stoi(value);
+    } else if (key == "ldpc_stall_iters") {
+      cfg.ldpc_stall_iters = std::stoi(value);
+    } else if (key == "ldpc_hopeless_iter") {
+      cfg.ldpc_hopeless_iter = std::stoi(value);
+    } else if (key == "ldpc_hopeless_errors") {
+      cfg.ldpc_hopeless_errors = std::stoi(value);
+    } else if (key == "osd_depth") {
+      cfg.osd_depth = std::stoi(value);
+    } else if (key == "subtract_passes") {
+      cfg.subtract_passes = std::stoi(value);
+    } else if (key == "decode_budget_sec") {
+      cfg.decode_budget_sec = std::stof(value);
+    } else if (key == "fft_planner") {
+      cfg.fft_planner = value;
+    } else if (key == "fft_wisdom_path") {
+      cfg.fft_wisdom_path = value;
+    } else if (key == "source") {
+      cfg.source = value;
+    } else if (key == "replay_path") {
+      cfg.replay_path = value;
+    } else if (key == "replay_format") {
+      cfg.replay_format = value;
+    } else if (key == "replay_sample_rate") {
+      cfg.replay_sample_rate = static_cast<uint32_t>(std::stoul(value));
+    } else if (key == "replay_realtime") {
+      cfg.replay_realtime = (value == "true" || value == "1");
+    } else if (key == "slot_wake_offset_ms") {
+      cfg.slot_wake_offset_ms = std::stoi(value);
+    } else if (key == "early_decode_sec") {
+      cfg.early_decode_sec.clear();
+      std::stringstream list(value);
+      std::string item;
+      while (std::getline(list, item, ','))
+        if (!trim(item).empty())
+          cfg.early_decode_sec.push_back(std::stof(trim(item)));
     }
   }
   return cfg;
@@ -0,0 +1,53 @@
+#include "dsp/channelizer.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace hf {
+
+Channelizer::Channelizer(const std::vector<DecimatorChain::Stage> &stages,
+                         size_t num_channels)
+    : mixed_(kBlock) {
+  channels_.reserve(num_channels);
+  for (size_t i = 0; i < num_channels; ++i)
+    channels_.emplace_back(stages);
+}
+
+void Channelizer::set_offset(size_t ch, double offset) {
+  auto &c = channels_[ch];
+  c.offset = offset;
+  c.phase = {1.0, 0.0};
+  c.step = std::polar(1.0, -2.0 * M_PI * offset);
+  c.decimator.reset();
+}
+
+size_t Channelizer::process(const std::complex<float> *in, size_t n,
+                            std::complex<float> *const *out) {
+  size_t produced = 0;
+  while (n > 0) {
+    size_t chunk = std::min(n, kBlock);
+    size_t len = 0;
+    for (size_t ch = 0; ch < channels_.size(); ++ch) {
+      auto &c = channels_[ch];
+      const std::complex<float> *src = in;
+      if (c.offset != 0.0) {
+        // The phasor runs in double precision and is renormalised once per
+        // block so its magnitude does not drift.
+        std::complex<double> ph = c.phase;
+        for (size_t i = 0; i < chunk; ++i) {
+          mixed_[i] = in[i] * std::complex<float>(ph);
+          ph *= c.step;
+        }
+        c.phase = ph / std::abs(ph);
+        src = mixed_.data();
+      }
+      len = c.decimator.process(src, chunk, out[ch] + produced);
+    }
+    produced += len;
+    in += chunk;
+    n -= chunk;
+  }
+  return produced;
+}
+
+} // namespace hf
@@ -0,0 +1,159 @@
+#include "dsp/costas_kernel.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#include <immintrin.h>
+#define HF_COSTAS_X86 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define HF_COSTAS_NEON 1
+#endif
+
+namespace hf {
+
+namespace {
+inline float score_of(float sync, float all) {
+  float rest = all - sync;
+  return rest > 0.0f ? 7.0f * sync / rest : 0.0f;
+}
+
+// Bins [k, n) one at a time.
+void score_tail(const float *const *sync_rows, const float *const *all_rows,
+                int rows, int k, int n, float *score) {
+  for (; k < n; ++k) {
+    float sync = 0.0f;
+    float all = 0.0f;
+    for (int r = 0; r < rows; ++r) {
+      sync += sync_rows[r][k];
+      all += all_rows[r][k];
+    }
+    score[k] = score_of(sync, all);
+  }
+}
+
+#if defined(HF_COSTAS_X86)
+// 8 bins per register, two registers per pass so the row loads of one
+// block overlap the adds of the other.
+__attribute__((target("avx2"))) void
+score_avx2(const float *const *sync_rows, const float *const *all_rows,
+           int rows, int n, float *score) {
+  const __m256 seven = _mm256_set1_ps(7.0f);
+  const __m256 zero = _mm256_setzero_ps();
+  int k = 0;
+  for (; k + 16 <= n; k += 16) {
+    __m256 s0 = zero, s1 = zero, a0 = zero, a1 = zero;
+    for (int r = 0; r < rows; ++r) {
+      s0 = _mm256_add_ps(s0, _mm256_loadu_ps(sync_rows[r] + k));
+      s1 = _mm256_add_ps(s1, _mm256_loadu_ps(sync_rows[r] + k + 8));
+      a0 = _mm256_add_ps(a0, _mm256_loadu_ps(all_rows[r] + k));
+      a1 = _mm256_add_ps(a1, _mm256_loadu_ps(all_rows[r] + k + 8));
+    }
+    __m256 rest0 = _mm256_sub_ps(a0, s0);
+    __m256 rest1 = _mm256_sub_ps(a1, s1);
+    __m256 v0 = _mm256_div_ps(_mm256_mul_ps(seven, s0), rest0);
+    __m256 v1 = _mm256_div_ps(_mm256_mul_ps(seven, s1), rest1);
+    v0 = _mm256_and_ps(v0, _mm256_cmp_ps(rest0, zero, _CMP_GT_OQ));
+    v1 = _mm256_and_ps(v1, _mm256_cmp_ps(rest1, zero, _CMP_GT_OQ));
+    _mm256_storeu_ps(score + k, v0);
+    _mm256_storeu_ps(score + k + 8, v1);
+  }
+  // GCC turns the tail into a jump without clearing the upper halves, which
+  // slows every SSE instruction after it.
+  _mm256_zeroupper();
+  score_tail(sync_rows, all_rows, rows, k, n, score);
+}
+
+__attribute__((target("sse2"))) void
+score_sse2(const float *const *sync_rows, const float *const *all_rows,
+           int rows, int n, float *score) {
+  const __m128 seven = _mm_set1_ps(7.0f);
+  const __m128 zero = _mm_setzero_ps();
+  int k = 0;
+  for (; k + 8 <= n; k += 8) {
+    __m128 s0 = zero, s1 = zero, a0 = zero, a1 = zero;
+    for (int r = 0; r < rows; ++r) {
+      s0 = _mm_add_ps(s0, _mm_loadu_ps(sync_rows[r] + k));
+      s1 = _mm_add_ps(s1, _mm_loadu_ps(sync_rows[r] + k + 4));
+      a0 = _mm_add_ps(a0, _mm_loadu_ps(all_rows[r] + k));
+      a1 = _mm_add_ps(a1, _mm_loadu_ps(all_rows[r] + k + 4));
+    }
+    __m128 rest0 = _mm_sub_ps(a0, s0);
+    __m128 rest1 = _mm_sub_ps(a1, s1);
+    __m128 v0 = _mm_div_ps(_mm_mul_ps(seven, s0), rest0);
+    __m128 v1 = _mm_div_ps(_mm_mul_ps(seven, s1), rest1);
+    v0 = _mm_and_ps(v0, _mm_cmpgt_ps(rest0, zero));
+    v1 = _mm_and_ps(v1, _mm_cmpgt_ps(rest1, zero));
+    _mm_storeu_ps(score + k, v0);
+    _mm_storeu_ps(score + k + 4, v1);
+  }
+  score_tail(sync_rows, all_rows, rows, k, n, score);
+}
+#elif defined(HF_COSTAS_NEON)
+void score_neon(const float *const *sync_rows, const float *const *all_rows,
+                int rows, int n, float *score) {
+  const float32x4_t seven = vdupq_n_f32(7.0f);
+  const float32x4_t zero = vdupq_n_f32(0.0f);
+  int k = 0;
+  for (; k + 8 <= n; k += 8) {
+    float32x4_t s0 = zero, s1 = zero, a0 = zero, a1 = zero;
+    for (int r = 0; r < rows; ++r) {
+      s0 = vaddq_f32(s0, vld1q_f32(sync_rows[r] + k));
+      s1 = vaddq_f32(s1, vld1q_f32(sync_rows[r] + k + 4));
+      a0 = vaddq_f32(a0, vld1q_f32(all_rows[r] + k));
+      a1 = vaddq_f32(a1, vld1q_f32(all_rows[r] + k + 4));
+    }
+    float32x4_t rest[2] = {vsubq_f32(a0, s0), vsubq_f32(a1, s1)};
+    float32x4_t num[2] = {vmulq_f32(seven, s0), vmulq_f32(seven, s1)};
+    for (int h = 0; h < 2; ++h) {
+#if defined(__aarch64__)
+      float32x4_t v = vdivq_f32(num[h], rest[h]);
+#else
+      // No vector divide on ARMv7: reciprocal estimate and two
+      // Newton-Raphson steps.
+      float32x4_t inv = vrecpeq_f32(rest[h]);
+      inv = vmulq_f32(inv, vrecpsq_f32(rest[h], inv));
+      inv = vmulq_f32(inv, vrecpsq_f32(rest[h], inv));
+      float32x4_t v = vmulq_f32(num[h], inv);
+#endif
+      uint32x4_t pos = vcgtq_f32(rest[h], zero);
+      v = vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(v), pos));
+      vst1q_f32(score + k + 4 * h, v);
+    }
+  }
+  score_tail(sync_rows, all_rows, rows, k, n, score);
+}
+#endif
+
+const CostasKernel &kernel() {
+  static const CostasKernel k = costas_kernels().front();
+  return k;
+}
+} // namespace
+
+void costas_score_scalar(const float *const *sync_rows,
+                         const float *const *all_rows, int rows, int n,
+                         float *score) {
+  score_tail(sync_rows, all_rows, rows, 0, n, score);
+}
+
+void costas_score(const float *const *sync_rows, const float *const *all_rows,
+                  int rows, int n, float *score) {
+  kernel().fn(sync_rows, all_rows, rows, n, score);
+}
+
+const char *costas_kernel_name() { return kernel().name; }
+
+std::vector<CostasKernel> costas_kernels() {
+  std::vector<CostasKernel> kernels;
+#if defined(HF_COSTAS_X86)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    kernels.push_back({"avx2", score_avx2});
+  kernels.push_back({"sse2", score_sse2});
+#elif defined(HF_COSTAS_NEON)
+  kernels.push_back({"neon", score_neon});
+#endif
+  kernels.push_back({"scalar", costas_score_scalar});
+  return kernels;
+}
+
+} // namespace hf
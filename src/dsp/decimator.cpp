@@ -0,0 +1,241 @@
+#include "dsp/decimator.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define HF_DECIM_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define HF_DECIM_SSE 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define HF_DECIM_NEON 1
+#endif
+
+namespace hf {
+
+namespace {
+constexpr float kPi = 3.14159265358979f;
+// Taps are padded to a multiple of this many complex samples so the SIMD
+// loops need no tail handling (8 floats = one AVX register).
+constexpr size_t kTapAlign = 4;
+
+// Zeroth-order modified Bessel function of the first kind.
+double bessel_i0(double x) {
+  double sum = 1.0;
+  double term = 1.0;
+  for (int k = 1; k < 32; ++k) {
+    term *= (x / (2.0 * k)) * (x / (2.0 * k));
+    sum += term;
+    if (term < 1e-12 * sum)
+      break;
+  }
+  return sum;
+}
+
+// Dot product of duplicated real taps against interleaved complex samples.
+// n is the length of both arrays in floats and is a multiple of 8.
+std::complex<float> dot_kernel(const float *taps, const float *x, size_t n) {
+#if defined(HF_DECIM_AVX)
+  __m256 acc0 = _mm256_setzero_ps();
+  __m256 acc1 = _mm256_setzero_ps();
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_loadu_ps(taps + i),
+                                             _mm256_loadu_ps(x + i)));
+    acc1 = _mm256_add_ps(acc1, _mm256_mul_ps(_mm256_loadu_ps(taps + i + 8),
+                                             _mm256_loadu_ps(x + i + 8)));
+  }
+  for (; i < n; i += 8)
+    acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_loadu_ps(taps + i),
+                                             _mm256_loadu_ps(x + i)));
+  __m256 acc = _mm256_add_ps(acc0, acc1);
+  __m128 s = _mm_add_ps(_mm256_castps256_ps128(acc),
+                        _mm256_extractf128_ps(acc, 1));
+  alignas(16) float v[4];
+  _mm_store_ps(v, s);
+  return {v[0] + v[2], v[1] + v[3]};
+#elif defined(HF_DECIM_SSE)
+  __m128 acc0 = _mm_setzero_ps();
+  __m128 acc1 = _mm_setzero_ps();
+  for (size_t i = 0; i < n; i += 8) {
+    acc0 = _mm_add_ps(acc0,
+                      _mm_mul_ps(_mm_loadu_ps(taps + i), _mm_loadu_ps(x + i)));
+    acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(taps + i + 4),
+                                       _mm_loadu_ps(x + i + 4)));
+  }
+  alignas(16) float v[4];
+  _mm_store_ps(v, _mm_add_ps(acc0, acc1));
+  return {v[0] + v[2], v[1] + v[3]};
+#elif defined(HF_DECIM_NEON)
+  float32x4_t acc0 = vdupq_n_f32(0.0f);
+  float32x4_t acc1 = vdupq_n_f32(0.0f);
+  for (size_t i = 0; i < n; i += 8) {
+    acc0 = vmlaq_f32(acc0, vld1q_f32(taps + i), vld1q_f32(x + i));
+    acc1 = vmlaq_f32(acc1, vld1q_f32(taps + i + 4), vld1q_f32(x + i + 4));
+  }
+  float32x4_t acc = vaddq_f32(acc0, acc1);
+  return {vgetq_lane_f32(acc, 0) + vgetq_lane_f32(acc, 2),
+          vgetq_lane_f32(acc, 1) + vgetq_lane_f32(acc, 3)};
+#else
+  float re = 0.0f;
+  float im = 0.0f;
+  for (size_t i = 0; i < n; i += 2) {
+    re += taps[i] * x[i];
+    im += taps[i + 1] * x[i + 1];
+  }
+  return {re, im};
+#endif
+}
+} // namespace
+
+std::vector<float> design_lowpass(int num_taps, float cutoff,
+                                  float atten_db) {
+  std::vector<float> taps(std::max(1, num_taps));
+  double beta = 0.0;
+  if (atten_db > 50.0f)
+    beta = 0.1102 * (atten_db - 8.7);
+  else if (atten_db > 21.0f)
+    beta = 0.5842 * std::pow(atten_db - 21.0, 0.4) +
+           0.07886 * (atten_db - 21.0);
+  const double mid = (taps.size() - 1) / 2.0;
+  const double norm = bessel_i0(beta);
+  double sum = 0.0;
+  for (size_t i = 0; i < taps.size(); ++i) {
+    double t = i - mid;
+    double sinc = (t == 0.0) ? 2.0 * cutoff
+                             : std::sin(2.0 * kPi * cutoff * t) / (kPi * t);
+    double r = mid > 0.0 ? t / mid : 0.0;
+    double w = bessel_i0(beta * std::sqrt(std::max(0.0, 1.0 - r * r))) / norm;
+    taps[i] = static_cast<float>(sinc * w);
+    sum += taps[i];
+  }
+  // Unity gain at DC.
+  for (auto &t : taps)
+    t = static_cast<float>(t / sum);
+  return taps;
+}
+
+FirDecimator::FirDecimator(int factor, int num_taps)
+    : FirDecimator(factor,
+                   design_lowpass(num_taps, 0.5f / std::max(1, factor))) {}
+
+FirDecimator::FirDecimator(int factor, const std::vector<float> &taps)
+    : factor_(std::max(1, factor)), taps_(taps) {
+  if (taps_.empty())
+    taps_.push_back(1.0f);
+  span_ = (taps_.size() + kTapAlign - 1) / kTapAlign * kTapAlign;
+  // Reverse so the kernel walks the history in ascending memory order; the
+  // zero padding sits at the oldest end and does not change the response.
+  kernel_.assign(2 * span_, 0.0f);
+  for (size_t j = 0; j < taps_.size(); ++j) {
+    size_t m = span_ - 1 - j;
+    kernel_[2 * m] = taps_[j];
+    kernel_[2 * m + 1] = taps_[j];
+  }
+  hist_.resize(span_ - 1 + kBlock);
+  reset();
+}
+
+void FirDecimator::reset() {
+  std::fill(hist_.begin(), hist_.end(), std::complex<float>{0.0f, 0.0f});
+  next_ = span_ - 1;
+}
+
+size_t FirDecimator::process(const std::complex<float> *in, size_t n,
+                             std::complex<float> *out) {
+  size_t produced = 0;
+  const size_t keep = span_ - 1;
+  while (n > 0) {
+    size_t chunk = std::min(n, kBlock);
+    std::copy(in, in + chunk, hist_.begin() + keep);
+    const size_t end = keep + chunk;
+    for (; next_ < end; next_ += factor_) {
+      const float *x =
+          reinterpret_cast<const float *>(hist_.data() + next_ - keep);
+      out[produced++] = dot_kernel(kernel_.data(), x, 2 * span_);
+    }
+    // Slide the newest span_ - 1 samples to the front for the next chunk.
+    std::copy(hist_.begin() + chunk, hist_.begin() + end, hist_.begin());
+    next_ -= chunk;
+    in += chunk;
+    n -= chunk;
+  }
+  return produced;
+}
+
+const char *FirDecimator::kernel_name() {
+#if defined(HF_DECIM_AVX)
+  return "avx";
+#elif defined(HF_DECIM_SSE)
+  return "sse2";
+#elif defined(HF_DECIM_NEON)
+  return "neon";
+#else
+  return "scalar";
+#endif
+}
+
+DecimatorChain::DecimatorChain(const std::vector<Stage> &stages) {
+  size_t block = kBlock;
+  for (const auto &s : stages) {
+    stages_.emplace_back(s.factor, s.num_taps);
+    factor_ *= stages_.back().factor();
+    block = stages_.back().max_output(block);
+    scratch_.emplace_back(block);
+  }
+  // The last stage writes straight to the caller's buffer.
+  if (!scratch_.empty())
+    scratch_.pop_back();
+}
+
+std::vector<DecimatorChain::Stage> DecimatorChain::plan(int factor) {
+  std::vector<int> factors;
+  while (factor > 1) {
+    int f = 8;
+    while (f > 1 && factor % f != 0)
+      --f;
+    if (f == 1)
+      f = factor; // prime factor above 8
+    factors.push_back(f);
+    factor /= f;
+  }
+  std::vector<Stage> stages;
+  for (size_t i = 0; i < factors.size(); ++i) {
+    int f = factors[i];
+    bool last = (i + 1 == factors.size());
+    stages.push_back({f, last ? 24 * f : 6 * f + 2});
+  }
+  return stages;
+}
+
+void DecimatorChain::reset() {
+  for (auto &s : stages_)
+    s.reset();
+}
+
+size_t DecimatorChain::process(const std::complex<float> *in, size_t n,
+                               std::complex<float> *out) {
+  if (stages_.empty()) {
+    std::copy(in, in + n, out);
+    return n;
+  }
+  size_t produced = 0;
+  while (n > 0) {
+    size_t chunk = std::min(n, kBlock);
+    const std::complex<float> *src = in;
+    size_t len = chunk;
+    for (size_t i = 0; i + 1 < stages_.size(); ++i) {
+      len = stages_[i].process(src, len, scratch_[i].data());
+      src = scratch_[i].data();
+    }
+    produced += stages_.back().process(src, len, out + produced);
+    in += chunk;
+    n -= chunk;
+  }
+  return produced;
+}
+
+} // namespace hf
@@ -1,4 +1,8 @@
 #include "dsp/decode.hpp"
+#include "dsp/ldpc_batch.hpp"
+#include "dsp/ldpc_layered.hpp"
+#include "dsp/ldpc_minsum.hpp"
+#include "dsp/ldpc_osd.hpp"
 #include <algorithm>
 #include <cctype>
 #include <cstring>
@@ -14,6 +18,9 @@ namespace hf {
 
 namespace {
 const int kGrayDecode[8] = {0,1,3,2,6,4,5,7};
+// OSD candidates further than this from the hard decisions are not
+// trusted to the CRC alone (the limit WSJT-X applies to its OSD decodes).
+constexpr int kOsdMaxDisagree = 36;
 
 void pack_bits(const uint8_t bit_array[], int num_bits, uint8_t packed[]) {
   std::memset(packed, 0, (num_bits + 7) / 8);
@@ -112,9 +119,19 @@ std::string decode_js8_payload(const std::array<uint8_t,10>& payload) {
   return decode_js8_payload_impl(payload);
 }
 
+LdpcAlgorithm LDPCDecoder::algorithm_from_string(const std::string &name) {
+  if (name == "sum_product")
+    return LdpcAlgorithm::SumProduct;
+  if (name == "layered")
+    return LdpcAlgorithm::Layered;
+  if (name == "min_sum")
+    return LdpcAlgorithm::MinSum;
+  return LdpcAlgorithm::BeliefPropagation;
+}
+
 DecodedMessage LDPCDecoder::decode(const std::vector<int> &tones,
                                    bool allow_js8) const {
-  float llr[FTX_LDPC_N] = {0};
+  std::vector<float> llrs(FTX_LDPC_N, 0.0f);
   int bit_idx = 0;
   for (int i = 0; i < (int)tones.size(); ++i) {
     if ((i < 7) || (i >= 36 && i < 43) || (i >= 72 && i < 79))
@@ -124,14 +141,94 @@ DecodedMessage LDPCDecoder::decode(const std::vector<int> &tones,
     int bits3 = kGrayDecode[symbol];
     for (int b = 2; b >= 0 && bit_idx < FTX_LDPC_N; --b) {
       int bit = (bits3 >> b) & 1;
-      llr[bit_idx++] = bit ? -1.0f : 1.0f;
+      llrs[bit_idx++] = bit ? 1.0f : -1.0f; // bp_decode: positive means 1
     }
   }
+  return decode(llrs, allow_js8);
+}
 
+DecodedMessage LDPCDecoder::decode(const std::vector<float> &llrs,
+                                   bool allow_js8) const {
+  float llr[FTX_LDPC_N] = {0};
+  std::copy_n(llrs.begin(), std::min<size_t>(llrs.size(), FTX_LDPC_N), llr);
+  return decode_one(llr, limits_, allow_js8);
+}
+
+void LDPCDecoder::decode(const float *const *llrs, size_t count,
+                         bool allow_js8, DecodedMessage *out) const {
+  decode(llrs, count, allow_js8, out, limits_);
+}
+
+void LDPCDecoder::decode(const float *const *llrs, size_t count,
+                         bool allow_js8, DecodedMessage *out,
+                         const LdpcLimits &limits) const {
+  if (algorithm_ != LdpcAlgorithm::BeliefPropagation) {
+    for (size_t i = 0; i < count; ++i)
+      out[i] = decode_one(llrs[i], limits, allow_js8);
+    return;
+  }
+  std::vector<uint8_t> plain(count * FTX_LDPC_N);
+  std::vector<int> errors(count);
+  std::vector<int> iterations(count);
+  bp_decode_batch(llrs, count, limits, plain.data(), errors.data(),
+                  iterations.data());
+  for (size_t i = 0; i < count; ++i) {
+    out[i] = finish(&plain[i * FTX_LDPC_N], errors[i], allow_js8);
+    out[i].ldpc_iterations = iterations[i];
+  }
+}
+
+DecodedMessage LDPCDecoder::decode_one(const float *llrs,
+                                       const LdpcLimits &limits,
+                                       bool allow_js8) const {
   uint8_t plain[FTX_LDPC_N];
   int errors = 0;
-  bp_decode(llr, 50, plain, &errors);
+  int iterations = -1;
+  switch (algorithm_) {
+  case LdpcAlgorithm::SumProduct: {
+    float llr[FTX_LDPC_N];
+    std::copy_n(llrs, FTX_LDPC_N, llr);
+    ldpc_decode(llr, limits.max_iters, plain, &errors);
+    break;
+  }
+  case LdpcAlgorithm::Layered:
+    errors = layered_decode(llrs, limits, plain, &iterations);
+    break;
+  case LdpcAlgorithm::MinSum:
+    errors = minsum_decode(llrs, limits, plain, &iterations);
+    break;
+  default:
+    bp_decode_batch(&llrs, 1, limits, plain, &errors, &iterations);
+    break;
+  }
+  auto msg = finish(plain, errors, allow_js8);
+  msg.ldpc_iterations = iterations;
+  return msg;
+}
+
+DecodedMessage LDPCDecoder::decode_osd(const float *llrs, int depth,
+                                       bool allow_js8) const {
+  uint8_t plain[FTX_LDPC_N];
+  int disagree = osd_decode(llrs, depth, plain);
+  // The all-zero codeword passes the CRC and is what silent input collapses
+  // to; like bp_decode, treat it as a failure.
+  bool zero = std::all_of(plain, plain + FTX_LDPC_N,
+                          [](uint8_t b) { return b == 0; });
+  if (disagree > kOsdMaxDisagree || zero) {
+    DecodedMessage msg{};
+    msg.ldpc_errors = -1;
+    msg.ldpc_iterations = -1;
+    msg.mode = Mode::FT8;
+    return msg;
+  }
+  auto msg = finish(plain, 0, allow_js8);
+  msg.ldpc_iterations = -1;
+  msg.osd_order = depth;
+  return msg;
+}
 
+DecodedMessage LDPCDecoder::finish(const uint8_t *plain, int errors,
+                                   bool allow_js8) const {
   DecodedMessage msg{};
   msg.ldpc_errors = errors;
   msg.mode = Mode::FT8;
@@ -1,15 +1,119 @@
 #include "dsp/demod.hpp"
 
+#include "dsp/tone_bank.hpp"
+
+extern "C" {
+#include "ft8/constants.h"
+}
+
 #include <algorithm>
 #include <cmath>
-#include <fftw3.h>
 
 namespace hf {
 
 namespace {
-constexpr int kCostasSeq[7] = {0, 1, 3, 2, 4, 6, 5};
+const uint8_t *const kCostasSeq = kFT8_Costas_pattern;
+constexpr int kCostasStart[3] = {0, 36, 72};
+// Bound on |LLR| so one confident symbol cannot dominate BP.
+constexpr float kMaxLlr = 25.0f;
+
+// ln I0(x), modified Bessel function of the first kind (Abramowitz and
+// Stegun 9.8.1 and 9.8.2; relative error below 2e-7).
+float log_i0(float x) {
+  if (x < 3.75f) {
+    float t = x / 3.75f;
+    t *= t;
+    return std::log1p(
+        t * (3.5156229f +
+             t * (3.0899424f +
+                  t * (1.2067492f +
+                       t * (0.2659732f + t * (0.0360768f + t * 0.0045813f))))));
+  }
+  float t = 3.75f / x;
+  float p = 0.39894228f +
+            t * (0.01328592f +
+                 t * (0.00225319f +
+                      t * (-0.00157565f +
+                           t * (0.00916281f +
+                                t * (-0.02057706f +
+                                     t * (0.02635537f +
+                                          t * (-0.01647633f +
+                                               t * 0.00392377f)))))));
+  return x - 0.5f * std::log(x) + std::log(p);
 }
 
+float log_sum_exp(float a, float b) {
+  return std::max(a, b) + std::log1p(std::exp(-std::fabs(a - b)));
+}
+
+// Hard tones, SNR and per-bit LLRs from the 8 tone powers of each symbol.
+// Noise power per bin N is the mean of the non-peak tones and signal power
+// S the mean peak less N. For noncoherent 8-FSK in white noise the
+// likelihood of tone j is proportional to I0(2 sqrt(S P_j) / N), so the
+// LLR of a bit is the log-sum of that over the tones whose Gray code has
+// the bit set minus the same over the tones where it is clear. Positive
+// LLRs favour 1, as bp_decode() expects. Symbols outside [first,
+// num_symbols) are erasures (LLR 0, tone 0).
+void decide(const float (*pow)[8], int first, int num_symbols, float bin_hz,
+            DemodulatedSignal &out) {
+  out.tones.assign(num_symbols, 0);
+  out.llrs.assign(174, 0.0f);
+  out.snr_db = 0.0f;
+  float sig_pow = 0.0f;
+  float noise_pow = 0.0f;
+  for (int s = first; s < num_symbols; ++s) {
+    int best_tone = 0;
+    for (int tone = 1; tone < 8; ++tone) {
+      if (pow[s][tone] > pow[s][best_tone])
+        best_tone = tone;
+    }
+    sig_pow += pow[s][best_tone];
+    for (int tone = 0; tone < 8; ++tone) {
+      if (tone != best_tone)
+        noise_pow += pow[s][tone];
+    }
+    out.tones[s] = best_tone;
+  }
+  const int used = num_symbols - first;
+  if (used <= 0)
+    return;
+
+  float avg_sig = sig_pow / used;
+  float avg_noise = noise_pow / (used * 7);
+  float noise_ref = avg_noise * (2500.0f / bin_hz);
+  if (noise_ref > 0.0f)
+    out.snr_db = 10.0f * std::log10(avg_sig / noise_ref);
+  if (avg_noise <= 0.0f)
+    return;
+
+  const float signal = std::max(avg_sig - avg_noise, 0.0f);
+  const float scale = 2.0f * std::sqrt(signal) / avg_noise;
+  int bit = 0;
+  for (int s = 0; s < num_symbols && bit < 174; ++s) {
+    if (s < 7 || (s >= 36 && s < 43) || s >= 72)
+      continue; // Costas sync symbols carry no data
+    if (s < first) {
+      bit += 3;
+      continue;
+    }
+    float metric[8];
+    for (int v = 0; v < 8; ++v)
+      metric[v] = log_i0(scale * std::sqrt(pow[s][kFT8_Gray_map[v]]));
+    for (int b = 2; b >= 0; --b) {
+      float one = -INFINITY;
+      float zero = -INFINITY;
+      for (int v = 0; v < 8; ++v) {
+        if ((v >> b) & 1)
+          one = log_sum_exp(one, metric[v]);
+        else
+          zero = log_sum_exp(zero, metric[v]);
+      }
+      out.llrs[bit++] = std::max(-kMaxLlr, std::min(kMaxLlr, one - zero));
+    }
+  }
+}
+} // namespace
+
 FSK8Demod::FSK8Demod(uint32_t sample_rate)
     : sample_rate_(sample_rate) {
   symbol_len_ = static_cast<int>(sample_rate_ / 6.25f);
@@ -30,25 +134,17 @@ DemodulatedSignal FSK8Demod::demodulate(
   if (t0 < 0 || t0 + symbol_len_ * 79 > static_cast<int>(frame.size()))
     return out;
 
-  std::vector<std::complex<float>> tmp(symbol_len_);
-  std::vector<std::complex<float>> fft_out(symbol_len_);
-  fftwf_plan plan = fftwf_plan_dft_1d(
-      symbol_len_, reinterpret_cast<fftwf_complex *>(tmp.data()),
-      reinterpret_cast<fftwf_complex *>(fft_out.data()), FFTW_FORWARD,
-      FFTW_ESTIMATE);
-
-  // Frequency refinement around initial estimate
-  std::vector<std::vector<float>> mags(7, std::vector<float>(symbol_len_));
-  for (int i = 0; i < 7; ++i) {
-    std::copy(frame.begin() + t0 + i * symbol_len_,
-              frame.begin() + t0 + (i + 1) * symbol_len_, tmp.begin());
-    fftwf_execute(plan);
-    for (int k = 0; k < symbol_len_; ++k) {
-      float re = fft_out[k].real();
-      float im = fft_out[k].imag();
-      mags[i][k] = re * re + im * im;
-    }
-  }
+  // Only a handful of bins per symbol are needed, so a Goertzel bank is
+  // used instead of a full FFT per symbol.
+  ToneBank bank(symbol_len_);
+
+  // Frequency refinement around initial estimate: bins base-2 .. base+9
+  // cover every Costas tone of the five trial offsets.
+  const int lo_bin = base_bin - 2;
+  bank.set_tones(lo_bin, 12);
+  float mags[7][12];
+  for (int i = 0; i < 7; ++i)
+    bank.energies(frame.data() + t0 + i * symbol_len_, mags[i]);
   float best_metric = -1.0f;
   int best_bin = base_bin;
   for (int b = base_bin - 2; b <= base_bin + 2; ++b) {
@@ -56,7 +152,7 @@ DemodulatedSignal FSK8Demod::demodulate(
       continue;
     float sum = 0.0f;
     for (int i = 0; i < 7; ++i)
-      sum += mags[i][b + kCostasSeq[i]];
+      sum += mags[i][b - lo_bin + kCostasSeq[i]];
     if (sum > best_metric) {
       best_metric = sum;
       best_bin = b;
@@ -64,6 +160,8 @@ DemodulatedSignal FSK8Demod::demodulate(
   }
 
   // Time refinement around start
+  bank.set_tones(best_bin, 8);
+  float tone_pow[8];
   int best_dt = 0;
   for (int dt = -symbol_len_ / 2; dt <= symbol_len_ / 2; dt += symbol_len_ / 8) {
     int start = t0 + dt;
@@ -71,13 +169,8 @@ DemodulatedSignal FSK8Demod::demodulate(
       continue;
     float sum = 0.0f;
     for (int i = 0; i < 7; ++i) {
-      std::copy(frame.begin() + start + i * symbol_len_,
-                frame.begin() + start + (i + 1) * symbol_len_, tmp.begin());
-      fftwf_execute(plan);
-      int bin = best_bin + kCostasSeq[i];
-      float re = fft_out[bin].real();
-      float im = fft_out[bin].imag();
-      sum += re * re + im * im;
+      bank.energies(frame.data() + start + i * symbol_len_, tone_pow);
+      sum += tone_pow[kCostasSeq[i]];
     }
     if (sum > best_metric) {
       best_metric = sum;
@@ -89,56 +182,118 @@ DemodulatedSignal FSK8Demod::demodulate(
   out.freq_hz = static_cast<float>(best_bin) * sample_rate_ / symbol_len_;
   out.time_sec = static_cast<float>(start) / sample_rate_;
 
-  // Demodulate 79 symbols and measure SNR
-  out.tones.resize(79);
-  out.snr_db = 0.0f;
-  float sig_pow = 0.0f;
-  float noise_pow = 0.0f;
+  // Tone powers of all 79 symbols, then decisions and soft bits
+  float pow[79][8];
   int sym_cnt = 0;
-  for (int s = 0; s < 79; ++s) {
-    int off = start + s * symbol_len_;
-    if (off + symbol_len_ > static_cast<int>(frame.size())) {
-      out.tones.resize(s);
+  for (; sym_cnt < 79; ++sym_cnt) {
+    int off = start + sym_cnt * symbol_len_;
+    if (off + symbol_len_ > static_cast<int>(frame.size()))
       break;
+    bank.energies(frame.data() + off, pow[sym_cnt]);
+  }
+  decide(pow, 0, sym_cnt, static_cast<float>(sample_rate_) / symbol_len_,
+         out);
+
+  return out;
+}
+
+DemodulatedSignal FSK8Demod::demodulate(const Spectrogram &spec,
+                                        const SyncCandidate &cand) const {
+  DemodulatedSignal out{};
+  demodulate(spec, cand, out);
+  return out;
+}
+
+void FSK8Demod::demodulate(const Spectrogram &spec, const SyncCandidate &cand,
+                           DemodulatedSignal &out) const {
+  out.freq_hz = cand.freq_hz;
+  out.time_sec = cand.time_sec;
+  out.snr_db = 0.0f;
+  out.tones.clear();
+  out.llrs.assign(174, 0.0f);
+
+  const int osr = spec.time_osr();
+  const int fosr = spec.freq_osr();
+  const int steps = spec.num_steps();
+  if (spec.empty())
+    return;
+
+  // Costas tone power summed over the blocks inside the spectrogram.
+  auto costas_metric = [&](int step, int fine) {
+    int sub = fine % fosr;
+    int bin = fine / fosr;
+    float sum = 0.0f;
+    for (int start : kCostasStart) {
+      int first = step + start * osr;
+      if (first < 0 || first + 6 * osr >= steps)
+        continue;
+      for (int i = 0; i < 7; ++i)
+        sum += spec.power(first + i * osr, sub, bin + kCostasSeq[i]);
     }
-    std::copy(frame.begin() + off, frame.begin() + off + symbol_len_,
-              tmp.begin());
-    fftwf_execute(plan);
-    int best_tone = 0;
-    float max_p = 0.0f;
-    float tone_p[8];
-    for (int tone = 0; tone < 8; ++tone) {
-      int bin = best_bin + tone;
-      float re = fft_out[bin].real();
-      float im = fft_out[bin].imag();
-      float p = re * re + im * im;
-      tone_p[tone] = p;
-      if (p > max_p) {
-        max_p = p;
-        best_tone = tone;
-      }
-    }
-    sig_pow += tone_p[best_tone];
-    for (int tone = 0; tone < 8; ++tone) {
-      if (tone != best_tone)
-        noise_pow += tone_p[tone];
+    return sum;
+  };
+
+  // Frequency refinement around initial estimate (+-2 tone bins)
+  const int fine0 = cand.bin * fosr + cand.freq_sub;
+  const int max_fine = (spec.num_bins() - 8) * fosr;
+  float best_metric = -1.0f;
+  int best_fine = fine0;
+  for (int f = fine0 - 2 * fosr; f <= fine0 + 2 * fosr; ++f) {
+    if (f < 0 || f >= max_fine)
+      continue;
+    float sum = costas_metric(cand.step, f);
+    if (sum > best_metric) {
+      best_metric = sum;
+      best_fine = f;
     }
-    ++sym_cnt;
-    out.tones[s] = best_tone;
   }
+  if (best_metric <= 0.0f)
+    return; // no sync block inside the spectrogram
 
-  if (sym_cnt > 0) {
-    float avg_sig = sig_pow / sym_cnt;
-    float avg_noise = noise_pow / (sym_cnt * 7);
-    float bin_bw = static_cast<float>(sample_rate_) / symbol_len_;
-    float noise_ref = avg_noise * (2500.0f / bin_bw);
-    if (noise_ref > 0.0f)
-      out.snr_db = 10.0f * std::log10(avg_sig / noise_ref);
+  // Time refinement around start (+-half a symbol). Moving the start
+  // moves a block out of the frame and its power with it, so compare
+  // per-block averages.
+  auto blocks_at = [&](int step) {
+    int n = 0;
+    for (int start : kCostasStart) {
+      int first = step + start * osr;
+      n += first >= 0 && first + 6 * osr < steps;
+    }
+    return n;
+  };
+  int best_step = cand.step;
+  best_metric /= std::max(1, blocks_at(cand.step));
+  const int dt_max = std::max(1, osr / 2);
+  for (int dt = -dt_max; dt <= dt_max; ++dt) {
+    int step = cand.step + dt;
+    int n = blocks_at(step);
+    if (dt == 0 || n == 0)
+      continue;
+    float avg = costas_metric(step, best_fine) / n;
+    if (avg > best_metric) {
+      best_metric = avg;
+      best_step = step;
+    }
   }
 
-  fftwf_destroy_plan(plan);
-  return out;
+  const int sub = best_fine % fosr;
+  const int bin = best_fine / fosr;
+  out.freq_hz = spec.freq_hz(sub, bin);
+  out.time_sec = spec.time_sec(best_step);
+
+  // Tone powers of all 79 symbols, then decisions and soft bits; symbols
+  // before the frame start are erased.
+  float pow[79][8] = {};
+  const int first_sym =
+      best_step < 0 ? std::min(79, (-best_step + osr - 1) / osr) : 0;
+  int sym_cnt = first_sym;
+  for (; sym_cnt < 79; ++sym_cnt) {
+    int step = best_step + sym_cnt * osr;
+    if (step >= steps)
+      break;
+    spec.powers(step, sub, bin, 8, pow[sym_cnt]);
+  }
+  decide(pow, first_sym, sym_cnt, spec.bin_hz(), out);
 }
 
 } // namespace hf
-
@@ -0,0 +1,90 @@
+#include "dsp/encode.hpp"
+
+extern "C" {
+#include "ft8/constants.h"
+#include "ft8/crc.h"
+}
+
+#include <cmath>
+
+namespace hf {
+
+namespace {
+int parity8(uint8_t v) {
+  v ^= v >> 4;
+  v ^= v >> 2;
+  v ^= v >> 1;
+  return v & 1;
+}
+} // namespace
+
+std::array<uint8_t, 79> ft8_encode(const std::array<uint8_t, 10> &payload) {
+  uint8_t a91[FTX_LDPC_K_BYTES] = {};
+  ftx_add_crc(payload.data(), a91);
+
+  // Systematic codeword: 91 message + CRC bits, then 83 parity bits.
+  uint8_t bits[FTX_LDPC_N];
+  for (int i = 0; i < FTX_LDPC_K; ++i)
+    bits[i] = (a91[i / 8] >> (7 - i % 8)) & 1;
+  for (int row = 0; row < FTX_LDPC_M; ++row) {
+    int p = 0;
+    for (int j = 0; j < FTX_LDPC_K_BYTES; ++j)
+      p ^= parity8(a91[j] & kFTX_LDPC_generator[row][j]);
+    bits[FTX_LDPC_K + row] = static_cast<uint8_t>(p);
+  }
+
+  std::array<uint8_t, 79> tones{};
+  int bit = 0;
+  for (int s = 0; s < FT8_NN; ++s) {
+    int block = s % FT8_SYNC_OFFSET;
+    if (s < 7 || (s >= 36 && s < 43) || s >= 72) {
+      tones[s] = kFT8_Costas_pattern[block % FT8_LENGTH_SYNC];
+      continue;
+    }
+    int v = bits[bit] << 2 | bits[bit + 1] << 1 | bits[bit + 2];
+    bit += 3;
+    tones[s] = kFT8_Gray_map[v];
+  }
+  return tones;
+}
+
+FT8Synthesizer::FT8Synthesizer(uint32_t sample_rate)
+    : sample_rate_(sample_rate) {
+  symbol_len_ = static_cast<int>(sample_rate_ / 6.25f);
+  // Gaussian-filtered rectangular frequency pulse, BT = 2.
+  const double bt = 2.0;
+  const double c = M_PI * std::sqrt(2.0 / std::log(2.0));
+  pulse_.resize(3 * static_cast<size_t>(symbol_len_));
+  for (size_t i = 0; i < pulse_.size(); ++i) {
+    double t = static_cast<double>(i) / symbol_len_ - 1.5;
+    pulse_[i] = static_cast<float>(
+        0.5 * (std::erf(c * bt * (t + 0.5)) - std::erf(c * bt * (t - 0.5))));
+  }
+}
+
+void FT8Synthesizer::synth(const std::array<uint8_t, 79> &tones,
+                           float freq_hz, std::complex<float> *out) const {
+  const int n = symbol_len_;
+  const int nn = static_cast<int>(tones.size());
+  // Per-sample phase step over nn + 2 symbols; the outer symbols repeat the
+  // first and last tone so the pulse tails settle at the edges.
+  const double carrier = 2.0 * M_PI * freq_hz / sample_rate_;
+  const double peak = 2.0 * M_PI / n; // one tone spacing
+  std::vector<double> dphi(static_cast<size_t>(nn + 2) * n, carrier);
+  for (int i = 0; i < nn; ++i)
+    for (int j = 0; j < 3 * n; ++j)
+      dphi[static_cast<size_t>(i) * n + j] += peak * tones[i] * pulse_[j];
+  for (int j = 0; j < 2 * n; ++j) {
+    dphi[j] += peak * tones[0] * pulse_[j + n];
+    dphi[static_cast<size_t>(nn) * n + j] += peak * tones[nn - 1] * pulse_[j];
+  }
+
+  double phi = 0.0;
+  for (size_t k = 0; k < num_samples(); ++k) {
+    out[k] = {static_cast<float>(std::cos(phi)),
+              static_cast<float>(std::sin(phi))};
+    phi = std::fmod(phi + dphi[k + n], 2.0 * M_PI);
+  }
+}
+
+} // namespace hf
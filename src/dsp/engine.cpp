@@ -1,38 +1,467 @@
 #include "dsp/engine.hpp"
-#include <future>
+
+#include "dsp/fft_plan.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
 
 namespace hf {
 
-DecodeEngine::DecodeEngine(uint32_t sample_rate, bool enable_js8)
-    : js8_enabled_(enable_js8), sync_(sample_rate), demod_(sample_rate) {}
+namespace {
+constexpr float kSlotSec = 15.0f;
+// Candidates per work item, decoded as one LDPC batch; large enough to
+// amortise the queue handoff and fill the SIMD lanes (8 with AVX, 4 with
+// SSE2/NEON), small enough that stealing evens out the tail.
+constexpr size_t kCandidateChunk = 8;
+// Second-stage decimation: taps per unit of factor, and how far beyond
+// the passband edge the filter's -6 dB point sits.
+constexpr int kDecimTapsPerFactor = 48;
+constexpr float kDecimSkirtHz = 150.0f;
+// Input samples mixed per block ahead of the decimator.
+constexpr size_t kMixBlock = 4096;
+constexpr double kTwoPi = 6.283185307179586;
+
+// A candidate this close to an earlier decode is the same signal.
+bool near(const SyncCandidate &c, const DecodedSignal &d, float bin_hz,
+          float symbol_sec) {
+  return std::fabs(c.freq_hz - d.freq_hz) <= 2.0f * bin_hz &&
+         std::fabs(c.time_sec - d.time_sec) <= symbol_sec;
+}
+
+// LDPC effort for a pass running late: half the iterations and an early
+// stall cutoff. Strong signals converge in a few iterations either way.
+LdpcLimits reduced(LdpcLimits limits) {
+  limits.max_iters = std::max(1, limits.max_iters / 2);
+  if (limits.stall_iters <= 0 || limits.stall_iters > 5)
+    limits.stall_iters = 5;
+  return limits;
+}
+} // namespace
+
+DecodeEngine::DecodeEngine(uint32_t sample_rate, bool enable_js8,
+                           int time_osr, int freq_osr, size_t threads)
+    : js8_enabled_(enable_js8), sample_rate_(sample_rate),
+      time_osr_(time_osr), freq_osr_(freq_osr), sync_(sample_rate),
+      demod_(sample_rate), pool_(std::make_unique<ThreadPool>(threads)),
+      scratch_(pool_->size(),
+               std::vector<DemodulatedSignal>(kCandidateChunk)),
+      subtractor_(sample_rate) {
+  for (auto &batch : scratch_) {
+    for (auto &s : batch) {
+      s.tones.reserve(79);
+      s.llrs.reserve(174);
+    }
+  }
+}
+
+void DecodeEngine::set_early_passes(std::vector<float> offsets_sec) {
+  offsets_sec.erase(std::remove_if(offsets_sec.begin(), offsets_sec.end(),
+                                   [](float t) {
+                                     return !(t > 0.0f && t < kSlotSec);
+                                   }),
+                    offsets_sec.end());
+  std::sort(offsets_sec.begin(), offsets_sec.end());
+  offsets_sec.erase(std::unique(offsets_sec.begin(), offsets_sec.end()),
+                    offsets_sec.end());
+  early_passes_ = std::move(offsets_sec);
+}
+
+bool DecodeEngine::set_decode_rate(uint32_t rate) {
+  if (rate == 0 || rate > sample_rate_ || sample_rate_ % rate != 0)
+    return false;
+  decim_ = static_cast<int>(sample_rate_ / rate);
+  SyncDetector sync(rate);
+  sync.set_max_candidates(sync_.max_candidates());
+  sync.set_min_score(sync_.min_score());
+  sync_ = sync;
+  demod_ = FSK8Demod(rate);
+  subtractor_ = SignalSubtractor(rate);
+  return true;
+}
+
+void DecodeEngine::prepare_plans(bool audio) const {
+  // A spectrogram builds its complex plan when constructed. begin_slot
+  // starts at the decode rate; audio then moves to the input rate and
+  // real FFTs.
+  Spectrogram slot_spec(decode_rate(), time_osr_, freq_osr_);
+  if (audio) {
+    Spectrogram spec(sample_rate_, time_osr_, freq_osr_);
+    FftPlans::r2c(spec.symbol_len() * spec.freq_osr());
+  }
+}
+
+DecodeEngine::SlotState DecodeEngine::begin_slot(float low_hz,
+                                                 float high_hz) const {
+  if (decim_ == 1) {
+    SlotState state(Spectrogram(sample_rate_, time_osr_, freq_osr_));
+    state.spec.set_storage(storage_);
+    state.low_hz = low_hz;
+    state.high_hz = high_hz;
+    return state;
+  }
+  const uint32_t rate = decode_rate();
+  const float center = 0.5f * (low_hz + high_hz);
+  SlotState state(Spectrogram(rate, time_osr_, freq_osr_, center));
+  state.spec.set_storage(storage_);
+  state.low_hz = low_hz;
+  state.high_hz = high_hz;
+  state.center_hz = center;
+  const float cutoff =
+      std::min(0.5f * (high_hz - low_hz) + kDecimSkirtHz, 0.5f * rate);
+  const int taps = kDecimTapsPerFactor * decim_;
+  state.decimator.emplace(decim_, design_lowpass(taps, cutoff / sample_rate_));
+  state.delay_sec = 0.5f * (taps - 1) / sample_rate_;
+  return state;
+}
+
+void DecodeEngine::begin_slot(float low_hz, float high_hz,
+                              SlotState &state) const {
+  SlotState next = begin_slot(low_hz, high_hz);
+  next.spec.take_buffers(state.spec);
+  next.reported.swap(state.reported);
+  next.residual.swap(state.residual);
+  next.audio_residual.swap(state.audio_residual);
+  next.baseband.swap(state.baseband);
+  next.reported.clear();
+  next.residual.clear();
+  next.audio_residual.clear();
+  next.baseband.clear();
+  state = std::move(next);
+}
 
 std::vector<DecodedSignal>
 DecodeEngine::process(const std::vector<std::complex<float>> &frame) const {
+  auto state = begin_slot();
+  return process(frame, frame.size(), true, state);
+}
+
+std::vector<DecodedSignal>
+DecodeEngine::process(const std::vector<std::complex<float>> &frame,
+                      size_t available, bool final, SlotState &state) const {
+  const auto t0 = now_();
+  std::vector<DecodedSignal> results;
+  const auto deadline =
+      t0 + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+               std::chrono::duration<float>(pass_budget(available, final)));
+  available = extend(frame, available, state);
+  bool full = decode_pass(state.spec, final, state, deadline, results);
+  if (!final || subtraction_passes_ <= 0 || !full)
+    return results;
+
+  // Weak signals hide under strong ones: remove what has been decoded and
+  // search the residual again while the budget allows.
+  const auto *input = state.decimator ? &state.baseband : &frame;
+  state.residual.assign(input->begin(), input->begin() + available);
+  residual_passes(state, available, t0, deadline, results);
+  return results;
+}
+
+std::vector<DecodedSignal>
+DecodeEngine::process(const std::vector<float> &audio) const {
+  auto state = begin_slot();
+  return process(audio, audio.size(), true, state);
+}
+
+std::vector<DecodedSignal>
+DecodeEngine::process(const std::vector<float> &audio, size_t available,
+                      bool final, SlotState &state) const {
+  const auto t0 = now_();
   std::vector<DecodedSignal> results;
-  auto cands = sync_.detect(frame);
-  std::vector<std::future<DecodedSignal>> futures;
-  futures.reserve(cands.size());
+  const auto deadline =
+      t0 + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+               std::chrono::duration<float>(pass_budget(available, final)));
+  available = extend(audio, available, state);
+  bool full = decode_pass(state.spec, final, state, deadline, results);
+  if (!final || subtraction_passes_ <= 0 || !full)
+    return results;
+
+  state.audio_residual.assign(audio.begin(), audio.begin() + available);
+  state.residual.resize(available);
+  residual_passes(state, available, t0, deadline, results);
+  return results;
+}
+
+size_t DecodeEngine::extend(const std::vector<std::complex<float>> &frame,
+                            size_t available, SlotState &state) const {
+  // One spectrogram per slot feeds sync and demod of every pass. Below the
+  // input rate everything downstream sees the decimated slot.
+  const auto *input = &frame;
+  if (state.decimator) {
+    if (!state.started)
+      state.baseband.assign(frame.size() / decim_ + 1, {0.0f, 0.0f});
+    available = decimate(frame, available, state);
+    input = &state.baseband;
+  }
+  if (!state.started) {
+    state.spec.reset(input->size());
+    state.started = true;
+  }
+  state.spec.extend(*input, available);
+  return std::min(available, input->size());
+}
+
+size_t DecodeEngine::extend(const std::vector<float> &audio, size_t available,
+                            SlotState &state) const {
+  auto &spec = state.spec;
+  if (!state.started) {
+    if (state.decimator) {
+      Spectrogram full(sample_rate_, time_osr_, freq_osr_);
+      full.take_buffers(spec);
+      spec = std::move(full);
+      spec.set_storage(storage_);
+      state.decimator.reset();
+      state.center_hz = 0.0f;
+      state.delay_sec = 0.0f;
+    }
+    spec.reset(audio.size());
+    state.started = true;
+  }
+  spec.extend(audio, available);
+  return std::min(available, audio.size());
+}
+
+void DecodeEngine::residual_passes(
+    SlotState &state, size_t available,
+    std::chrono::steady_clock::time_point start,
+    std::chrono::steady_clock::time_point deadline,
+    std::vector<DecodedSignal> &results) const {
+  auto &spec = state.spec;
+  auto &audio = state.audio_residual;
+  size_t subtracted = 0;
+  auto pass_start = start;
+  for (int pass = 0; pass < subtraction_passes_; ++pass) {
+    // Assume the next pass costs as much as the last one.
+    auto now = now_();
+    if (now + (now - pass_start) > deadline)
+      break;
+    pass_start = now;
+    size_t end = state.reported.size();
+    if (std::none_of(state.reported.begin() + subtracted,
+                     state.reported.begin() + end,
+                     [](const DecodedSignal &d) {
+                       return d.crc_ok && d.mode == Mode::FT8;
+                     }))
+      break; // nothing new to remove
+    if (audio.empty()) {
+      subtract(state, subtracted, available);
+      spec.compute(state.residual);
+    } else {
+      // The subtractor fits the positive-frequency half of a real signal,
+      // which carries half its amplitude: remove the fit twice over.
+      for (size_t i = 0; i < available; ++i)
+        state.residual[i] = {audio[i], 0.0f};
+      subtract(state, subtracted, available);
+      for (size_t i = 0; i < available; ++i)
+        audio[i] = 2.0f * state.residual[i].real() - audio[i];
+      spec.compute(audio);
+    }
+    subtracted = end;
+    ++state.stats.residual_passes;
+    // Residual passes report CRC-valid messages only.
+    size_t before = results.size();
+    bool full = decode_pass(spec, false, state, deadline, results);
+    if (results.size() == before || !full)
+      break;
+  }
+}
+
+float DecodeEngine::pass_budget(size_t available, bool final) const {
+  if (final)
+    return time_budget_sec_;
+  const float at = available / static_cast<float>(sample_rate_);
+  auto next = std::upper_bound(early_passes_.begin(), early_passes_.end(),
+                               at + 0.01f);
+  return (next == early_passes_.end() ? kSlotSec : *next) - at;
+}
+
+size_t DecodeEngine::decimate(const std::vector<std::complex<float>> &frame,
+                              size_t available, SlotState &state) const {
+  available = std::min(available, frame.size());
+  const double w = -kTwoPi * state.center_hz / sample_rate_;
+  const std::complex<double> step(std::cos(w), std::sin(w));
+  std::vector<std::complex<float>> mixed(kMixBlock);
+  while (state.consumed < available) {
+    const size_t n = std::min(kMixBlock, available - state.consumed);
+    for (size_t i = 0; i < n; ++i) {
+      mixed[i] = frame[state.consumed + i] *
+                 std::complex<float>(state.nco.real(), state.nco.imag());
+      state.nco *= step;
+    }
+    state.nco /= std::abs(state.nco); // keep the NCO on the unit circle
+    state.produced += state.decimator->process(
+        mixed.data(), n, state.baseband.data() + state.produced);
+    state.consumed += n;
+  }
+  return state.produced;
+}
+
+void DecodeEngine::subtract(SlotState &state, size_t first,
+                            size_t available) const {
+  for (size_t i = first; i < state.reported.size(); ++i) {
+    const auto &d = state.reported[i];
+    if (!d.crc_ok || d.mode != Mode::FT8)
+      continue;
+    subtractor_.subtract(state.residual.data(), available,
+                         ft8_encode(d.payload), d.freq_hz - state.center_hz,
+                         d.time_sec);
+  }
+}
+
+bool DecodeEngine::decode_pass(const Spectrogram &spec, bool final,
+                               SlotState &state,
+                               std::chrono::steady_clock::time_point deadline,
+                               std::vector<DecodedSignal> &results) const {
+  auto cands = sync_.detect(spec, state.low_hz, state.high_hz);
+
+  const float symbol_sec = spec.symbol_len() /
+                           static_cast<float>(spec.sample_rate());
+  std::vector<SyncCandidate> work;
+  work.reserve(cands.size());
   for (const auto &cand : cands) {
-    futures.emplace_back(std::async(std::launch::async, [this, &frame, cand]() {
-      DecodedSignal res{};
-      auto sig = demod_.demodulate(frame, cand);
-      res.freq_hz = sig.freq_hz;
-      res.time_sec = sig.time_sec;
-      res.snr_db = sig.snr_db;
-      auto msg = decoder_.decode(sig.tones, js8_enabled_);
-      res.mode = msg.mode;
-      res.crc_ok = msg.crc_ok;
-      res.ldpc_errors = msg.ldpc_errors;
-      res.text = msg.text;
-      return res;
-    }));
-  }
-  results.reserve(futures.size());
-  for (auto &f : futures) {
-    results.push_back(f.get());
+    bool seen = std::any_of(
+        state.reported.begin(), state.reported.end(),
+        [&](const DecodedSignal &d) {
+          return d.crc_ok && near(cand, d, spec.bin_hz(), symbol_sec);
+        });
+    if (!seen)
+      work.push_back(cand);
   }
-  return results;
+
+  // Workers take chunks in score order from a shared cursor, so whatever
+  // the deadline cuts off is the weakest candidates. The cost of a
+  // full-effort chunk is measured as it goes; once the chunks left would
+  // overrun the deadline the rest of the pass runs at reduced effort.
+  const int64_t workers = static_cast<int64_t>(pool_->size());
+  const LdpcLimits reduced_limits = reduced(decoder_.limits());
+  std::atomic<size_t> next{0};
+  std::atomic<size_t> skipped{0};
+  std::atomic<size_t> reduced_count{0};
+  std::atomic<bool> degraded{false};
+  std::atomic<int64_t> chunk_ns{0};
+  std::atomic<int64_t> osd_ns[3] = {};
+  auto ns_left = [&](Clock::time_point now) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(deadline -
+                                                                now)
+        .count();
+  };
+  // OSD order affordable for `queued` more failures, assuming every worker
+  // gets its share at the cost per call measured so far in this pass.
+  auto osd_order = [&](size_t queued) {
+    const int64_t left = ns_left(now_());
+    for (int d = std::min(osd_depth_, 2); d > 0; --d) {
+      if (osd_ns[d].load(std::memory_order_relaxed) *
+              static_cast<int64_t>(queued) <=
+          left * workers)
+        return d;
+    }
+    return 0;
+  };
+
+  std::vector<DecodedSignal> decoded(work.size());
+  std::vector<uint8_t> ran(work.size(), 0);
+  pool_->parallel_for(
+      pool_->size(), 1, [&](size_t, size_t, size_t worker) {
+        auto &batch = scratch_[worker];
+        const float *llrs[kCandidateChunk];
+        DecodedMessage msgs[kCandidateChunk];
+        for (;;) {
+          const size_t first = next.fetch_add(kCandidateChunk);
+          if (first >= work.size())
+            break;
+          const size_t count = std::min(kCandidateChunk, work.size() - first);
+          const auto start = now_();
+          const int64_t left = ns_left(start);
+          if (left <= 0) {
+            skipped += count;
+            continue;
+          }
+          const int64_t chunks_left = static_cast<int64_t>(
+              (work.size() - first + kCandidateChunk - 1) / kCandidateChunk);
+          if (chunk_ns.load(std::memory_order_relaxed) * chunks_left >
+              left * workers)
+            degraded = true;
+          const bool cut = degraded;
+
+          // Demodulate a chunk, then run LDPC on all of it at once with
+          // one codeword per SIMD lane.
+          for (size_t k = 0; k < count; ++k) {
+            demod_.demodulate(spec, work[first + k], batch[k]);
+            llrs[k] = batch[k].llrs.data();
+          }
+          if (cut)
+            decoder_.decode(llrs, count, js8_enabled_, msgs, reduced_limits);
+          else
+            decoder_.decode(llrs, count, js8_enabled_, msgs);
+          for (size_t k = 0; k < count && osd_depth_ > 0 && !cut; ++k) {
+            if (msgs[k].crc_ok)
+              continue;
+            size_t taken = std::min(work.size(), next.load());
+            int order = osd_order(work.size() - taken + count - k);
+            if (order == 0)
+              break;
+            auto t = now_();
+            auto m = decoder_.decode_osd(llrs[k], order, js8_enabled_);
+            osd_ns[order].store(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    now_() - t)
+                    .count(),
+                std::memory_order_relaxed);
+            if (m.crc_ok) {
+              m.ldpc_iterations = msgs[k].ldpc_iterations;
+              msgs[k] = std::move(m);
+            }
+          }
+          for (size_t k = 0; k < count; ++k) {
+            const auto &sig = batch[k];
+            auto &msg = msgs[k];
+            auto &res = decoded[first + k];
+            res.freq_hz = sig.freq_hz;
+            res.time_sec = sig.time_sec;
+            res.snr_db = sig.snr_db;
+            res.mode = msg.mode;
+            res.crc_ok = msg.crc_ok;
+            res.ldpc_errors = msg.ldpc_errors;
+            res.ldpc_iterations = msg.ldpc_iterations;
+            res.text = std::move(msg.text);
+            res.payload = msg.payload;
+            ran[first + k] = 1;
+          }
+          if (cut)
+            reduced_count += count;
+          else
+            chunk_ns.store(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                               now_() - start)
+                               .count(),
+                           std::memory_order_relaxed);
+        }
+      });
+  state.stats.candidates += work.size();
+  state.stats.skipped += skipped;
+  state.stats.reduced += reduced_count;
+
+  results.reserve(decoded.size());
+  for (size_t i = 0; i < decoded.size(); ++i) {
+    auto &res = decoded[i];
+    if (!ran[i])
+      continue;
+    if (res.crc_ok) {
+      bool dup = std::any_of(state.reported.begin(), state.reported.end(),
+                             [&](const DecodedSignal &d) {
+                               return d.crc_ok && d.mode == res.mode &&
+                                      d.text == res.text;
+                             });
+      if (dup)
+        continue;
+    } else if (!final) {
+      continue;
+    }
+    state.reported.push_back(res);
+    // Reported times are relative to the input frame.
+    res.time_sec -= state.delay_sec;
+    results.push_back(std::move(res));
+  }
+  return skipped == 0 && reduced_count == 0;
 }
 
 } // namespace hf
-
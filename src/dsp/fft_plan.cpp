@@ -0,0 +1,100 @@
+#include "dsp/fft_plan.hpp"
+
+#include <map>
+#include <mutex>
+#include <tuple>
+
+namespace hf {
+
+namespace {
+struct Registry {
+  std::mutex mutex;
+  unsigned rigor = FFTW_MEASURE;
+  std::map<std::tuple<int, int, bool>, fftwf_plan> plans; // sign 0 = r2c
+
+  ~Registry() {
+    for (auto &kv : plans)
+      fftwf_destroy_plan(kv.second);
+  }
+};
+
+Registry &registry() {
+  static Registry r;
+  return r;
+}
+} // namespace
+
+void FftPlans::set_rigor(unsigned flags) {
+  auto &r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  r.rigor = flags;
+}
+
+unsigned FftPlans::rigor_from_string(const std::string &name) {
+  if (name == "estimate")
+    return FFTW_ESTIMATE;
+  if (name == "patient")
+    return FFTW_PATIENT;
+  return FFTW_MEASURE;
+}
+
+bool FftPlans::load_wisdom(const std::string &path) {
+  auto &r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  return fftwf_import_wisdom_from_filename(path.c_str()) != 0;
+}
+
+bool FftPlans::save_wisdom(const std::string &path) {
+  auto &r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  return fftwf_export_wisdom_to_filename(path.c_str()) != 0;
+}
+
+fftwf_plan FftPlans::dft(int n, int sign, bool aligned) {
+  auto &r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  auto key = std::make_tuple(n, sign, aligned);
+  auto it = r.plans.find(key);
+  if (it != r.plans.end())
+    return it->second;
+
+  // Plan on scratch buffers: measuring overwrites them. An unaligned plan
+  // is made on deliberately misaligned pointers so FFTW cannot assume more.
+  FftBuffer in(n + 1);
+  FftBuffer out(n + 1);
+  unsigned flags = r.rigor | (aligned ? 0u : FFTW_UNALIGNED);
+  fftwf_complex *pin = reinterpret_cast<fftwf_complex *>(in.data());
+  fftwf_complex *pout = reinterpret_cast<fftwf_complex *>(out.data());
+  if (!aligned) {
+    pin = reinterpret_cast<fftwf_complex *>(
+        reinterpret_cast<float *>(in.data()) + 1);
+    pout = reinterpret_cast<fftwf_complex *>(
+        reinterpret_cast<float *>(out.data()) + 1);
+  }
+  fftwf_plan plan = fftwf_plan_dft_1d(n, pin, pout, sign, flags);
+  r.plans.emplace(key, plan);
+  return plan;
+}
+
+fftwf_plan FftPlans::r2c(int n, bool aligned) {
+  auto &r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  auto key = std::make_tuple(n, 0, aligned);
+  auto it = r.plans.find(key);
+  if (it != r.plans.end())
+    return it->second;
+
+  FftRealBuffer in(n + 1);
+  FftBuffer out(n / 2 + 2);
+  unsigned flags = r.rigor | (aligned ? 0u : FFTW_UNALIGNED);
+  float *pin = in.data() + (aligned ? 0 : 1);
+  fftwf_complex *pout = reinterpret_cast<fftwf_complex *>(out.data());
+  if (!aligned)
+    pout = reinterpret_cast<fftwf_complex *>(
+        reinterpret_cast<float *>(out.data()) + 1);
+  fftwf_plan plan = fftwf_plan_dft_r2c_1d(n, pin, pout, flags);
+  r.plans.emplace(key, plan);
+  return plan;
+}
+
+} // namespace hf
@@ -0,0 +1,294 @@
+#include "dsp/ldpc_batch.hpp"
+
+extern "C" {
+#include "ft8/constants.h"
+}
+
+#include <algorithm>
+#include <vector>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define HF_LDPC_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define HF_LDPC_SSE 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define HF_LDPC_NEON 1
+#endif
+
+namespace hf {
+
+namespace {
+// Minimal float vector: one codeword per lane.
+#if defined(HF_LDPC_AVX)
+constexpr int kLanes = 8;
+struct Vec {
+  __m256 v;
+};
+inline Vec load(const float *p) { return {_mm256_loadu_ps(p)}; }
+inline void store(float *p, Vec a) { _mm256_storeu_ps(p, a.v); }
+inline Vec splat(float x) { return {_mm256_set1_ps(x)}; }
+inline Vec operator+(Vec a, Vec b) { return {_mm256_add_ps(a.v, b.v)}; }
+inline Vec operator-(Vec a, Vec b) { return {_mm256_sub_ps(a.v, b.v)}; }
+inline Vec operator*(Vec a, Vec b) { return {_mm256_mul_ps(a.v, b.v)}; }
+inline Vec operator/(Vec a, Vec b) { return {_mm256_div_ps(a.v, b.v)}; }
+inline Vec greater(Vec a, Vec b) {
+  return {_mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ)};
+}
+// mask ? a : b
+inline Vec select(Vec mask, Vec a, Vec b) {
+  return {_mm256_blendv_ps(b.v, a.v, mask.v)};
+}
+inline unsigned lane_bits(Vec mask) {
+  return static_cast<unsigned>(_mm256_movemask_ps(mask.v));
+}
+#elif defined(HF_LDPC_SSE)
+constexpr int kLanes = 4;
+struct Vec {
+  __m128 v;
+};
+inline Vec load(const float *p) { return {_mm_loadu_ps(p)}; }
+inline void store(float *p, Vec a) { _mm_storeu_ps(p, a.v); }
+inline Vec splat(float x) { return {_mm_set1_ps(x)}; }
+inline Vec operator+(Vec a, Vec b) { return {_mm_add_ps(a.v, b.v)}; }
+inline Vec operator-(Vec a, Vec b) { return {_mm_sub_ps(a.v, b.v)}; }
+inline Vec operator*(Vec a, Vec b) { return {_mm_mul_ps(a.v, b.v)}; }
+inline Vec operator/(Vec a, Vec b) { return {_mm_div_ps(a.v, b.v)}; }
+inline Vec greater(Vec a, Vec b) { return {_mm_cmpgt_ps(a.v, b.v)}; }
+inline Vec select(Vec mask, Vec a, Vec b) {
+  return {_mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v))};
+}
+inline unsigned lane_bits(Vec mask) {
+  return static_cast<unsigned>(_mm_movemask_ps(mask.v));
+}
+#elif defined(HF_LDPC_NEON)
+constexpr int kLanes = 4;
+struct Vec {
+  float32x4_t v;
+};
+inline Vec load(const float *p) { return {vld1q_f32(p)}; }
+inline void store(float *p, Vec a) { vst1q_f32(p, a.v); }
+inline Vec splat(float x) { return {vdupq_n_f32(x)}; }
+inline Vec operator+(Vec a, Vec b) { return {vaddq_f32(a.v, b.v)}; }
+inline Vec operator-(Vec a, Vec b) { return {vsubq_f32(a.v, b.v)}; }
+inline Vec operator*(Vec a, Vec b) { return {vmulq_f32(a.v, b.v)}; }
+inline Vec operator/(Vec a, Vec b) {
+#if defined(__aarch64__)
+  return {vdivq_f32(a.v, b.v)};
+#else
+  float x[4], y[4];
+  vst1q_f32(x, a.v);
+  vst1q_f32(y, b.v);
+  for (int i = 0; i < 4; ++i)
+    x[i] /= y[i];
+  return {vld1q_f32(x)};
+#endif
+}
+inline Vec greater(Vec a, Vec b) {
+  return {vreinterpretq_f32_u32(vcgtq_f32(a.v, b.v))};
+}
+inline Vec select(Vec mask, Vec a, Vec b) {
+  return {vbslq_f32(vreinterpretq_u32_f32(mask.v), a.v, b.v)};
+}
+inline unsigned lane_bits(Vec mask) {
+  uint32_t m[4];
+  vst1q_u32(m, vreinterpretq_u32_f32(mask.v));
+  return (m[0] & 1) | (m[1] & 2) | (m[2] & 4) | (m[3] & 8);
+}
+#else
+constexpr int kLanes = 4;
+struct Vec {
+  float v[kLanes];
+};
+inline Vec load(const float *p) {
+  Vec r;
+  std::copy_n(p, kLanes, r.v);
+  return r;
+}
+inline void store(float *p, Vec a) { std::copy_n(a.v, kLanes, p); }
+inline Vec splat(float x) {
+  Vec r;
+  std::fill_n(r.v, kLanes, x);
+  return r;
+}
+template <typename Op>
+inline Vec lanewise(Vec a, Vec b, Op op) {
+  Vec r;
+  for (int i = 0; i < kLanes; ++i)
+    r.v[i] = op(a.v[i], b.v[i]);
+  return r;
+}
+inline Vec operator+(Vec a, Vec b) {
+  return lanewise(a, b, [](float x, float y) { return x + y; });
+}
+inline Vec operator-(Vec a, Vec b) {
+  return lanewise(a, b, [](float x, float y) { return x - y; });
+}
+inline Vec operator*(Vec a, Vec b) {
+  return lanewise(a, b, [](float x, float y) { return x * y; });
+}
+inline Vec operator/(Vec a, Vec b) {
+  return lanewise(a, b, [](float x, float y) { return x / y; });
+}
+// Masks are 1.0f / 0.0f in the portable build.
+inline Vec greater(Vec a, Vec b) {
+  return lanewise(a, b, [](float x, float y) { return x > y ? 1.0f : 0.0f; });
+}
+inline Vec select(Vec mask, Vec a, Vec b) {
+  Vec r;
+  for (int i = 0; i < kLanes; ++i)
+    r.v[i] = mask.v[i] != 0.0f ? a.v[i] : b.v[i];
+  return r;
+}
+inline unsigned lane_bits(Vec mask) {
+  unsigned bits = 0;
+  for (int i = 0; i < kLanes; ++i)
+    bits |= (mask.v[i] != 0.0f ? 1u : 0u) << i;
+  return bits;
+}
+#endif
+
+// Same rational approximations as fast_tanh / fast_atanh in ldpc.c.
+inline Vec tanh_approx(Vec x) {
+  Vec x2 = x * x;
+  Vec a = x * (splat(945.0f) + x2 * (splat(105.0f) + x2));
+  Vec b = splat(945.0f) + x2 * (splat(420.0f) + x2 * splat(15.0f));
+  Vec r = a / b;
+  r = select(greater(x, splat(4.97f)), splat(1.0f), r);
+  return select(greater(splat(-4.97f), x), splat(-1.0f), r);
+}
+
+inline Vec atanh_approx(Vec x) {
+  Vec x2 = x * x;
+  Vec a = x * (splat(945.0f) + x2 * (splat(-735.0f) + x2 * splat(64.0f)));
+  Vec b = splat(945.0f) + x2 * (splat(-1050.0f) + x2 * splat(225.0f));
+  return a / b;
+}
+
+constexpr int N = FTX_LDPC_N;
+constexpr int M = FTX_LDPC_M;
+
+// Decode up to kLanes codewords; storage is lane-minor ([node][lane]).
+void decode_lanes(const float *const *llrs, int count,
+                  const LdpcLimits &limits, uint8_t *plain, int *errors,
+                  int *iterations) {
+  std::vector<float> cw(N * kLanes, 0.0f);
+  std::vector<float> tov(N * 3 * kLanes, 0.0f);
+  std::vector<float> toc(M * 7 * kLanes, 0.0f);
+  for (int l = 0; l < count; ++l)
+    for (int n = 0; n < N; ++n)
+      cw[n * kLanes + l] = llrs[l][n];
+
+  unsigned bits[N];
+  std::vector<LdpcStopRule> rules(kLanes, LdpcStopRule(limits));
+  int iters_run = 0;
+  const unsigned all = (1u << kLanes) - 1;
+  // Lanes past count hold zero LLRs, collapse to all zeros and finish at
+  // once; they are never written back.
+  unsigned active = all;
+
+  auto freeze = [&](unsigned lanes) {
+    for (int l = 0; l < count; ++l) {
+      if (!(lanes >> l & 1))
+        continue;
+      for (int n = 0; n < N; ++n)
+        plain[l * N + n] = static_cast<uint8_t>(bits[n] >> l & 1);
+      errors[l] = rules[l].best();
+      iterations[l] = iters_run;
+    }
+  };
+
+  for (int iter = 0; iter < limits.max_iters && active; ++iter) {
+    iters_run = iter;
+    // Hard decisions, one bit per lane.
+    unsigned nonzero = 0;
+    for (int n = 0; n < N; ++n) {
+      const float *t = &tov[n * 3 * kLanes];
+      Vec sum = load(&cw[n * kLanes]) + load(t) + load(t + kLanes) +
+                load(t + 2 * kLanes);
+      bits[n] = lane_bits(greater(sum, splat(0.0f)));
+      nonzero |= bits[n];
+    }
+    // Parity errors per lane.
+    int errs[kLanes] = {};
+    for (int m = 0; m < M; ++m) {
+      unsigned x = 0;
+      for (int i = 0; i < kFTX_LDPC_Num_rows[m]; ++i)
+        x ^= bits[kFTX_LDPC_Nm[m][i] - 1];
+      for (int l = 0; l < kLanes; ++l)
+        errs[l] += x >> l & 1;
+    }
+    unsigned done = active & ~nonzero; // converged to all zeros
+    for (int l = 0; l < kLanes; ++l) {
+      if (!(active >> l & 1) || !(nonzero >> l & 1))
+        continue;
+      if (rules[l].update(iter, errs[l]))
+        done |= 1u << l;
+    }
+    if (done) {
+      freeze(done);
+      active &= ~done;
+      if (!active)
+        break;
+    }
+
+    // Bits to checks.
+    for (int m = 0; m < M; ++m) {
+      for (int ni = 0; ni < kFTX_LDPC_Num_rows[m]; ++ni) {
+        int n = kFTX_LDPC_Nm[m][ni] - 1;
+        Vec t = load(&cw[n * kLanes]);
+        for (int mi = 0; mi < 3; ++mi)
+          if (kFTX_LDPC_Mn[n][mi] - 1 != m)
+            t = t + load(&tov[(n * 3 + mi) * kLanes]);
+        store(&toc[(m * 7 + ni) * kLanes],
+              tanh_approx(splat(0.0f) - t * splat(0.5f)));
+      }
+    }
+    // Checks to bits.
+    for (int n = 0; n < N; ++n) {
+      for (int mi = 0; mi < 3; ++mi) {
+        int m = kFTX_LDPC_Mn[n][mi] - 1;
+        Vec p = splat(1.0f);
+        for (int ni = 0; ni < kFTX_LDPC_Num_rows[m]; ++ni)
+          if (kFTX_LDPC_Nm[m][ni] - 1 != n)
+            p = p * load(&toc[(m * 7 + ni) * kLanes]);
+        store(&tov[(n * 3 + mi) * kLanes],
+              splat(-2.0f) * atanh_approx(p));
+      }
+    }
+  }
+  // Lanes still running keep the last decision, as bp_decode does.
+  if (active) {
+    iters_run = limits.max_iters;
+    freeze(active);
+  }
+}
+} // namespace
+
+void bp_decode_batch(const float *const *llrs, size_t count,
+                     const LdpcLimits &limits, uint8_t *plain, int *errors,
+                     int *iterations) {
+  for (size_t first = 0; first < count; first += kLanes) {
+    int n = static_cast<int>(std::min<size_t>(kLanes, count - first));
+    decode_lanes(llrs + first, n, limits, plain + first * N, errors + first,
+                 iterations + first);
+  }
+}
+
+int bp_batch_lanes() { return kLanes; }
+
+const char *bp_batch_kernel_name() {
+#if defined(HF_LDPC_AVX)
+  return "avx";
+#elif defined(HF_LDPC_SSE)
+  return "sse2";
+#elif defined(HF_LDPC_NEON)
+  return "neon";
+#else
+  return "scalar";
+#endif
+}
+
+} // namespace hf
@@ -0,0 +1,76 @@
+#include "dsp/ldpc_layered.hpp"
+
+extern "C" {
+#include "ft8/constants.h"
+}
+
+#include <cstring>
+
+namespace hf {
+
+namespace {
+constexpr int N = FTX_LDPC_N;
+constexpr int M = FTX_LDPC_M;
+} // namespace
+
+int layered_decode(const float *llrs, const LdpcLimits &limits,
+                   uint8_t *plain, int *iterations) {
+  float app[N];
+  float msg[M][7] = {};
+  std::memcpy(app, llrs, sizeof(app));
+
+  uint8_t bits[N];
+  LdpcStopRule rule(limits);
+  std::memset(plain, 0, N);
+  *iterations = limits.max_iters;
+  for (int iter = 0; iter < limits.max_iters; ++iter) {
+    for (int m = 0; m < M; ++m) {
+      const int deg = kFTX_LDPC_Num_rows[m];
+      float t[7];
+      float p[7];
+      for (int i = 0; i < deg; ++i) {
+        t[i] = app[kFTX_LDPC_Nm[m][i] - 1] - msg[m][i];
+        p[i] = ldpc_tanh(-t[i] / 2);
+      }
+      // Product of the other inputs from prefix and suffix products, which
+      // avoids dividing by a zero input.
+      float prefix[8];
+      prefix[0] = 1.0f;
+      for (int i = 0; i < deg; ++i)
+        prefix[i + 1] = prefix[i] * p[i];
+      float suffix = 1.0f;
+      for (int i = deg - 1; i >= 0; --i) {
+        float r = -2 * ldpc_atanh(prefix[i] * suffix);
+        suffix *= p[i];
+        msg[m][i] = r;
+        app[kFTX_LDPC_Nm[m][i] - 1] = t[i] + r;
+      }
+    }
+
+    int ones = 0;
+    for (int n = 0; n < N; ++n) {
+      bits[n] = app[n] > 0;
+      ones += bits[n];
+    }
+    if (ones == 0) {
+      *iterations = iter + 1;
+      break; // all zeros is not a valid message, as in bp_decode
+    }
+    int errors = 0;
+    for (int m = 0; m < M; ++m) {
+      uint8_t x = 0;
+      for (int i = 0; i < kFTX_LDPC_Num_rows[m]; ++i)
+        x ^= bits[kFTX_LDPC_Nm[m][i] - 1];
+      errors += x;
+    }
+    if (errors < rule.best())
+      std::memcpy(plain, bits, N);
+    if (rule.update(iter + 1, errors)) {
+      *iterations = iter + 1;
+      break;
+    }
+  }
+  return rule.best();
+}
+
+} // namespace hf
@@ -0,0 +1,102 @@
+#include "dsp/ldpc_minsum.hpp"
+
+extern "C" {
+#include "ft8/constants.h"
+}
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+namespace hf {
+
+namespace {
+constexpr int N = FTX_LDPC_N;
+constexpr int M = FTX_LDPC_M;
+// Fixed-point scale: 4 steps per LLR unit, so the demodulator's +-25
+// clipping fits int8 check messages.
+constexpr float kScale = 4.0f;
+constexpr int kMsgMax = 127;
+constexpr int kAppMax = 4095;
+
+int saturate(int v, int lim) { return std::max(-lim, std::min(lim, v)); }
+
+int syndrome_errors(const uint8_t *bits) {
+  int errors = 0;
+  for (int m = 0; m < M; ++m) {
+    uint8_t x = 0;
+    for (int i = 0; i < kFTX_LDPC_Num_rows[m]; ++i)
+      x ^= bits[kFTX_LDPC_Nm[m][i] - 1];
+    errors += x;
+  }
+  return errors;
+}
+} // namespace
+
+int minsum_decode(const float *llrs, const LdpcLimits &limits,
+                  uint8_t *plain, int *iterations) {
+  // Internally a positive value favours 0, the usual min-sum convention.
+  int16_t app[N];
+  int8_t msg[M][7] = {};
+  for (int n = 0; n < N; ++n)
+    app[n] = static_cast<int16_t>(
+        saturate(static_cast<int>(std::lround(-llrs[n] * kScale)), kMsgMax));
+
+  uint8_t bits[N];
+  LdpcStopRule rule(limits);
+  std::memset(plain, 0, N);
+  *iterations = limits.max_iters;
+  for (int iter = 0; iter < limits.max_iters; ++iter) {
+    for (int m = 0; m < M; ++m) {
+      const int deg = kFTX_LDPC_Num_rows[m];
+      int t[7];
+      int min1 = kAppMax, min2 = kAppMax, min_at = 0;
+      int sign = 0;
+      for (int i = 0; i < deg; ++i) {
+        int n = kFTX_LDPC_Nm[m][i] - 1;
+        t[i] = app[n] - msg[m][i];
+        int mag = std::abs(t[i]);
+        sign ^= t[i] < 0;
+        if (mag < min1) {
+          min2 = min1;
+          min1 = mag;
+          min_at = i;
+        } else if (mag < min2) {
+          min2 = mag;
+        }
+      }
+      // Normalised by 3/4 to offset min-sum's overestimate.
+      int out1 = std::min(kMsgMax, (min1 * 3) >> 2);
+      int out2 = std::min(kMsgMax, (min2 * 3) >> 2);
+      for (int i = 0; i < deg; ++i) {
+        int n = kFTX_LDPC_Nm[m][i] - 1;
+        int mag = i == min_at ? out2 : out1;
+        int s = sign ^ (t[i] < 0);
+        int r = s ? -mag : mag;
+        msg[m][i] = static_cast<int8_t>(r);
+        app[n] = static_cast<int16_t>(saturate(t[i] + r, kAppMax));
+      }
+    }
+
+    int ones = 0;
+    for (int n = 0; n < N; ++n) {
+      bits[n] = app[n] < 0;
+      ones += bits[n];
+    }
+    if (ones == 0) {
+      *iterations = iter + 1;
+      break; // all zeros is not a valid message, as in bp_decode
+    }
+    int errors = syndrome_errors(bits);
+    if (errors < rule.best())
+      std::memcpy(plain, bits, N);
+    if (rule.update(iter + 1, errors)) {
+      *iterations = iter + 1;
+      break;
+    }
+  }
+  return rule.best();
+}
+
+} // namespace hf
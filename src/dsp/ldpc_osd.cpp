@@ -0,0 +1,163 @@
+#include "dsp/ldpc_osd.hpp"
+
+extern "C" {
+#include "ft8/constants.h"
+}
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numeric>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace hf {
+
+namespace {
+constexpr int N = FTX_LDPC_N;
+constexpr int K = FTX_LDPC_K;
+constexpr int kWords = (N + 63) / 64;
+using Row = std::array<uint64_t, kWords>;
+
+int lowest_bit(uint64_t x) {
+#if defined(_MSC_VER)
+  unsigned long i;
+  _BitScanForward64(&i, x);
+  return static_cast<int>(i);
+#else
+  return __builtin_ctzll(x);
+#endif
+}
+
+bool test(const Row &r, int bit) { return (r[bit >> 6] >> (bit & 63)) & 1; }
+
+void flip(Row &r, int bit) { r[bit >> 6] ^= uint64_t{1} << (bit & 63); }
+
+void xor_into(Row &dst, const Row &src) {
+  for (int w = 0; w < kWords; ++w)
+    dst[w] ^= src[w];
+}
+
+// Rows of the systematic generator: message bit k, then the parity bits
+// it feeds (column k of kFTX_LDPC_generator).
+const std::array<Row, K> &generator_rows() {
+  static const std::array<Row, K> rows = [] {
+    std::array<Row, K> g{};
+    for (int k = 0; k < K; ++k) {
+      flip(g[k], k);
+      for (int m = 0; m < FTX_LDPC_M; ++m)
+        if ((kFTX_LDPC_generator[m][k / 8] >> (7 - k % 8)) & 1)
+          flip(g[k], K + m);
+    }
+    return g;
+  }();
+  return rows;
+}
+
+// Sum of rel over the set bits of diff, abandoned once it reaches limit.
+float discrepancy(const Row &diff, const float *rel, float limit) {
+  float d = 0.0f;
+  for (int w = 0; w < kWords; ++w) {
+    for (uint64_t x = diff[w]; x; x &= x - 1) {
+      d += rel[64 * w + lowest_bit(x)];
+      if (d >= limit)
+        return d;
+    }
+  }
+  return d;
+}
+
+int popcount(const Row &r) {
+  int n = 0;
+  for (int w = 0; w < kWords; ++w)
+    for (uint64_t x = r[w]; x; x &= x - 1)
+      ++n;
+  return n;
+}
+} // namespace
+
+int osd_decode(const float *llrs, int depth, uint8_t *plain) {
+  float rel[N];
+  Row hard{};
+  for (int i = 0; i < N; ++i) {
+    rel[i] = std::fabs(llrs[i]);
+    if (llrs[i] > 0.0f)
+      flip(hard, i);
+  }
+  int order[N];
+  std::iota(order, order + N, 0);
+  std::stable_sort(order, order + N,
+                   [&](int a, int b) { return rel[a] > rel[b]; });
+
+  // Eliminate column by column in order of reliability. Afterwards row k
+  // is the only one with a bit at pivot[k], and pivot[] runs from the most
+  // to the least reliable basis position.
+  std::array<Row, K> g = generator_rows();
+  int pivot[K];
+  int rank = 0;
+  for (int i = 0; i < N && rank < K; ++i) {
+    const int col = order[i];
+    int r = rank;
+    while (r < K && !test(g[r], col))
+      ++r;
+    if (r == K)
+      continue; // dependent on the more reliable columns
+    std::swap(g[r], g[rank]);
+    for (int j = 0; j < K; ++j)
+      if (j != rank && test(g[j], col))
+        xor_into(g[j], g[rank]);
+    pivot[rank++] = col;
+  }
+
+  // Codeword matching the hard decisions on the basis, as a difference
+  // from the hard decisions.
+  Row base{};
+  for (int k = 0; k < K; ++k)
+    if (test(hard, pivot[k]))
+      xor_into(base, g[k]);
+  xor_into(base, hard);
+
+  Row best_diff = base;
+  float best = discrepancy(base, rel, INFINITY);
+  // A flipped basis bit alone costs its own reliability, which bounds the
+  // candidate from below; the least reliable positions are tried first so
+  // the bound cuts the search short.
+  if (depth >= 1) {
+    for (int k = K - 1; k >= 0 && rel[pivot[k]] < best; --k) {
+      Row d = base;
+      xor_into(d, g[k]);
+      float s = discrepancy(d, rel, best);
+      if (s < best) {
+        best = s;
+        best_diff = d;
+      }
+    }
+  }
+  if (depth >= 2) {
+    const float weakest = rel[pivot[K - 1]];
+    for (int k = K - 2; k >= 0 && rel[pivot[k]] + weakest < best; --k) {
+      Row dk = base;
+      xor_into(dk, g[k]);
+      for (int l = K - 1; l > k && rel[pivot[k]] + rel[pivot[l]] < best;
+           --l) {
+        Row d = dk;
+        xor_into(d, g[l]);
+        float s = discrepancy(d, rel, best);
+        if (s < best) {
+          best = s;
+          best_diff = d;
+        }
+      }
+    }
+  }
+
+  Row word = hard;
+  xor_into(word, best_diff);
+  for (int i = 0; i < N; ++i)
+    plain[i] = test(word, i);
+  return popcount(best_diff);
+}
+
+} // namespace hf
@@ -0,0 +1,164 @@
+#include "dsp/spectrogram.hpp"
+
+#include "dsp/fft_plan.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
+namespace hf {
+
+namespace {
+// Log8 codes: 0.5 dB steps from 120 dB below a full-scale tone to 7.5 dB
+// above it.
+constexpr float kLogFloorDb = -120.0f;
+constexpr float kLogStepDb = 0.5f;
+} // namespace
+
+Spectrogram::Spectrogram(uint32_t sample_rate, int time_osr, int freq_osr)
+    : sample_rate_(sample_rate), time_osr_(std::max(1, time_osr)),
+      freq_osr_(std::max(1, freq_osr)) {
+  symbol_len_ = static_cast<int>(sample_rate_ / 6.25f); // 1920 at 12 kHz
+  num_bins_ = symbol_len_ / 2;
+  // A unit tone over a symbol peaks at symbol_len^2 in power.
+  log_ref_ = static_cast<float>(symbol_len_) * symbol_len_;
+  for (int c = 0; c < 256; ++c)
+    log_table_[c] =
+        log_ref_ * std::pow(10.0f, (kLogFloorDb + c * kLogStepDb) / 10.0f);
+  // Build (or fetch) the plan now so the first frame does not pay for it.
+  FftPlans::dft(symbol_len_ * freq_osr_, FFTW_FORWARD);
+}
+
+Spectrogram::Spectrogram(uint32_t sample_rate, int time_osr, int freq_osr,
+                         float center_hz)
+    : Spectrogram(sample_rate, time_osr, freq_osr) {
+  num_bins_ = symbol_len_;
+  two_sided_ = true;
+  base_hz_ = center_hz - (num_bins_ / 2) * bin_hz();
+}
+
+void Spectrogram::compute(const std::vector<std::complex<float>> &frame) {
+  reset(frame.size());
+  extend(frame, frame.size());
+}
+
+void Spectrogram::compute(const std::vector<float> &frame) {
+  reset(frame.size());
+  extend(frame, frame.size());
+}
+
+void Spectrogram::reset(size_t max_samples) {
+  num_steps_ = 0;
+  max_steps_ = 0;
+  if (max_samples >= static_cast<size_t>(symbol_len_))
+    max_steps_ = (static_cast<int>(max_samples) - symbol_len_) /
+                     (symbol_len_ / time_osr_) +
+                 1;
+  const size_t values =
+      static_cast<size_t>(max_steps_) * freq_osr_ * num_bins_;
+  power_.clear();
+  log_power_.clear();
+  if (storage_ == Storage::Float)
+    power_.assign(values, 0.0f);
+  else
+    log_power_.assign(values, 0);
+}
+
+void Spectrogram::take_buffers(Spectrogram &other) {
+  power_.swap(other.power_);
+  log_power_.swap(other.log_power_);
+}
+
+Spectrogram::Storage Spectrogram::storage_from_string(const std::string &name) {
+  return name == "log8" ? Storage::Log8 : Storage::Float;
+}
+
+void Spectrogram::powers(int step, int freq_sub, int bin, int n,
+                         float *out) const {
+  const size_t i = index(step, freq_sub) + bin;
+  if (storage_ == Storage::Float) {
+    std::copy_n(&power_[i], n, out);
+    return;
+  }
+  for (int k = 0; k < n; ++k)
+    out[k] = log_table_[log_power_[i + k]];
+}
+
+const float *Spectrogram::row(int step, int freq_sub, float *scratch) const {
+  if (storage_ == Storage::Float)
+    return &power_[index(step, freq_sub)];
+  powers(step, freq_sub, 0, num_bins_, scratch);
+  return scratch;
+}
+
+int Spectrogram::extend(const std::vector<std::complex<float>> &frame,
+                        size_t available) {
+  return extend_frame(frame, available);
+}
+
+int Spectrogram::extend(const std::vector<float> &frame, size_t available) {
+  return extend_frame(frame, available);
+}
+
+template <typename T>
+int Spectrogram::extend_frame(const std::vector<T> &frame, size_t available) {
+  constexpr bool kReal = std::is_same<T, float>::value;
+  available = std::min(available, frame.size());
+  if (available < static_cast<size_t>(symbol_len_))
+    return 0;
+
+  const int step_len = symbol_len_ / time_osr_;
+  const int fft_size = symbol_len_ * freq_osr_;
+  const int end_step = std::min(
+      max_steps_,
+      (static_cast<int>(available) - symbol_len_) / step_len + 1);
+  if (end_step <= num_steps_)
+    return 0;
+
+  // Zero padding beyond symbol_len_ interpolates freq_osr_ sub-bins per tone.
+  std::conditional_t<kReal, FftRealBuffer, FftBuffer> tmp(fft_size);
+  FftBuffer fft_out(fft_size);
+  fftwf_plan plan = kReal ? FftPlans::r2c(fft_size)
+                          : FftPlans::dft(fft_size, FFTW_FORWARD);
+
+  // Two-sided rows start at -fs/2, i.e. in the upper half of the FFT. A
+  // real FFT only returns 0..fs/2; the negative half mirrors it.
+  const int first_fft =
+      two_sided_ ? fft_size - (num_bins_ / 2) * freq_osr_ : 0;
+  auto fft_bin = [&](int k, int sub) {
+    int j = (first_fft + k * freq_osr_ + sub) % fft_size;
+    return kReal && j > fft_size / 2 ? fft_size - j : j;
+  };
+
+  const float inv_ref = 1.0f / log_ref_;
+  const int first_step = num_steps_;
+  for (int step = first_step; step < end_step; ++step) {
+    auto first = frame.begin() + static_cast<size_t>(step) * step_len;
+    std::copy(first, first + symbol_len_, tmp.begin());
+    std::fill(tmp.begin() + symbol_len_, tmp.end(), T{});
+    FftPlans::execute(plan, tmp.data(), fft_out.data());
+    for (int sub = 0; sub < freq_osr_; ++sub) {
+      const size_t row = index(step, sub);
+      if (storage_ == Storage::Float) {
+        float *dst = &power_[row];
+        for (int k = 0; k < num_bins_; ++k)
+          dst[k] = std::norm(fft_out[fft_bin(k, sub)]);
+        continue;
+      }
+      uint8_t *dst = &log_power_[row];
+      for (int k = 0; k < num_bins_; ++k) {
+        float p = std::norm(fft_out[fft_bin(k, sub)]) * inv_ref;
+        float code = p > 0.0f ? (10.0f * std::log10(p) - kLogFloorDb) /
+                                    kLogStepDb
+                              : 0.0f;
+        dst[k] = static_cast<uint8_t>(
+            std::lround(std::max(0.0f, std::min(255.0f, code))));
+      }
+    }
+  }
+
+  num_steps_ = end_step;
+  return end_step - first_step;
+}
+
+} // namespace hf
@@ -0,0 +1,65 @@
+#include "dsp/ssb.hpp"
+
+#include "dsp/decimator.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace hf {
+
+UsbDemod::UsbDemod(uint32_t sample_rate, float low_hz, float high_hz,
+                   int num_taps) {
+  // Odd length so the centre tap sits on the output sample.
+  num_taps = std::max(1, num_taps) | 1;
+  const float fs = static_cast<float>(sample_rate);
+  high_hz = std::min(high_hz, 0.5f * fs);
+  low_hz = std::max(0.0f, std::min(low_hz, high_hz));
+  auto lp = design_lowpass(num_taps, 0.5f * (high_hz - low_hz) / fs);
+  const double w = 2.0 * 3.14159265358979 * 0.5 * (low_hz + high_hz) / fs;
+  const int mid = num_taps / 2;
+  re_.resize(num_taps);
+  im_.resize(num_taps);
+  for (int k = 0; k < num_taps; ++k) {
+    re_[k] = static_cast<float>(lp[k] * std::cos(w * (k - mid)));
+    im_[k] = static_cast<float>(lp[k] * std::sin(w * (k - mid)));
+  }
+}
+
+void UsbDemod::process(const std::complex<float> *in, size_t n,
+                       float *out) const {
+  process(in, n, 0, n, out);
+}
+
+void UsbDemod::process(const std::complex<float> *in, size_t n, size_t first,
+                       size_t last, float *out) const {
+  last = std::min(last, n);
+  if (first >= last)
+    return;
+  const size_t half = half_span();
+  const size_t taps = re_.size();
+  // Zero-padded copy of in[first - half, last + half) so the inner loop
+  // needs no bounds checks.
+  std::vector<std::complex<float>> x(last - first + 2 * half);
+  const size_t from = first - std::min(first, half);
+  const size_t to = std::min(n, last + half);
+  std::copy(in + from, in + to, x.begin() + (from + half - first));
+  out += first;
+  for (size_t i = 0; i < last - first; ++i) {
+    // Real part of the complex convolution; x[i + taps - 1 - k] is
+    // in[first + i + half - k].
+    const std::complex<float> *p = &x[i + taps - 1];
+    float acc = 0.0f;
+    for (size_t k = 0; k < taps; ++k)
+      acc += re_[k] * p[-static_cast<ptrdiff_t>(k)].real() -
+             im_[k] * p[-static_cast<ptrdiff_t>(k)].imag();
+    out[i] = acc;
+  }
+}
+
+void UsbDemod::process(const std::vector<std::complex<float>> &in,
+                       std::vector<float> &out) const {
+  out.resize(in.size());
+  process(in.data(), in.size(), out.data());
+}
+
+} // namespace hf
@@ -0,0 +1,123 @@
+#include "dsp/subtract.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace hf {
+
+namespace {
+// Centred moving sum of width 2 * half + 1 over v, in place.
+template <typename T>
+void box_sum(std::vector<T> &v, std::vector<T> &prefix, size_t half) {
+  const size_t n = v.size();
+  prefix.assign(n + 1, T{});
+  for (size_t i = 0; i < n; ++i)
+    prefix[i + 1] = prefix[i] + v[i];
+  for (size_t i = 0; i < n; ++i) {
+    size_t lo = i > half ? i - half : 0;
+    size_t hi = std::min(n, i + half + 1);
+    v[i] = prefix[hi] - prefix[lo];
+  }
+}
+} // namespace
+
+SignalSubtractor::SignalSubtractor(uint32_t sample_rate)
+    : sample_rate_(sample_rate), synth_(sample_rate),
+      ref_(synth_.num_samples()) {}
+
+float SignalSubtractor::score(const std::complex<float> *frame,
+                              size_t available, long t0, int stride) const {
+  const int n = synth_.symbol_len();
+  float total = 0.0f;
+  for (int s = 0; s < 79; ++s) {
+    long first = t0 + static_cast<long>(s) * n;
+    int j0 = static_cast<int>(std::max(0L, -first));
+    int j1 = static_cast<int>(
+        std::min<long>(n, static_cast<long>(available) - first));
+    std::complex<float> z{0.0f, 0.0f};
+    for (int j = j0; j < j1; j += stride)
+      z += frame[first + j] * std::conj(ref_[static_cast<size_t>(s) * n + j]);
+    total += std::norm(z);
+  }
+  return total;
+}
+
+bool SignalSubtractor::subtract(std::complex<float> *frame, size_t available,
+                                const std::array<uint8_t, 79> &tones,
+                                float freq_hz, float time_sec) {
+  const int n = synth_.symbol_len();
+  const long len = static_cast<long>(ref_.size());
+  long t0 = std::lround(time_sec * sample_rate_);
+  if (t0 + len <= 0 || t0 >= static_cast<long>(available))
+    return false;
+
+  // Time: coarse to fine around the demodulator's estimate, which is only
+  // as fine as the spectrogram step.
+  synth_.synth(tones, freq_hz, ref_.data());
+  struct Search {
+    int step;
+    int span;
+    int stride;
+  };
+  for (Search s : {Search{n / 16, 8, 4}, Search{n / 128, 4, 2},
+                   Search{std::max(1, n / 640), 3, 1}}) {
+    long best = t0;
+    float best_score = -1.0f;
+    for (int k = -s.span; k <= s.span; ++k) {
+      float v = score(frame, available, t0 + k * s.step, s.stride);
+      if (v > best_score) {
+        best_score = v;
+        best = t0 + k * s.step;
+      }
+    }
+    t0 = best;
+  }
+
+  // Frequency: phase advance between consecutive symbol correlations.
+  std::complex<double> turn{0.0, 0.0};
+  std::complex<float> prev{0.0f, 0.0f};
+  for (int s = 0; s < 79; ++s) {
+    long first = t0 + static_cast<long>(s) * n;
+    std::complex<float> z{0.0f, 0.0f};
+    for (int j = 0; j < n; ++j) {
+      long i = first + j;
+      if (i >= 0 && i < static_cast<long>(available))
+        z += frame[i] * std::conj(ref_[static_cast<size_t>(s) * n + j]);
+    }
+    if (s > 0)
+      turn += std::complex<double>(z * std::conj(prev));
+    prev = z;
+  }
+  float df = static_cast<float>(std::arg(turn) / (2.0 * M_PI) *
+                                sample_rate_ / n);
+  synth_.synth(tones, freq_hz + df, ref_.data());
+
+  // Complex amplitude: received times conjugate reference, smoothed by a
+  // triangular window two symbols wide. Samples outside the frame carry
+  // no weight.
+  amp_.assign(ref_.size(), {0.0, 0.0});
+  weight_.assign(ref_.size(), 0.0);
+  for (long k = 0; k < len; ++k) {
+    long i = t0 + k;
+    if (i < 0 || i >= static_cast<long>(available))
+      continue;
+    amp_[k] = std::complex<double>(frame[i] * std::conj(ref_[k]));
+    weight_[k] = 1.0;
+  }
+  const size_t half = static_cast<size_t>(n / 2);
+  for (int pass = 0; pass < 2; ++pass) {
+    box_sum(amp_, amp_prefix_, half);
+    box_sum(weight_, weight_prefix_, half);
+  }
+
+  for (long k = 0; k < len; ++k) {
+    long i = t0 + k;
+    if (i < 0 || i >= static_cast<long>(available) || weight_[k] <= 0.0)
+      continue;
+    auto a = amp_[k] / weight_[k];
+    frame[i] -= ref_[k] * std::complex<float>(a);
+  }
+  return true;
+}
+
+} // namespace hf
@@ -1,14 +1,25 @@
 #include "dsp/sync.hpp"
 
+#include "dsp/costas_kernel.hpp"
+
+extern "C" {
+#include "ft8/constants.h"
+}
+
 #include <algorithm>
-#include <fftw3.h>
-#include <numeric>
+#include <cmath>
+#include <cstdlib>
 
 namespace hf {
 
 namespace {
-// 7x7 Costas array used by FT8/JS8
-constexpr int kCostasSeq[7] = {0, 1, 3, 2, 4, 6, 5};
+// Symbols at which the three Costas blocks start.
+constexpr int kCostasStart[3] = {0, 36, 72};
+// Search window for the start of a transmission. Nominally 0.5 s into the
+// slot; earlier starts lose symbols at the frame start and are found by
+// their later blocks.
+constexpr float kMinStartSec = -2.0f;
+constexpr float kMaxStartSec = 3.0f;
 } // namespace
 
 SyncDetector::SyncDetector(uint32_t sample_rate)
@@ -19,64 +30,202 @@ SyncDetector::SyncDetector(uint32_t sample_rate)
 
 std::vector<SyncCandidate>
 SyncDetector::detect(const std::vector<std::complex<float>> &frame) const {
+  Spectrogram spec(sample_rate_);
+  spec.compute(frame);
+  return detect(spec);
+}
+
+std::vector<SyncCandidate>
+SyncDetector::detect(const std::vector<float> &audio) const {
+  Spectrogram spec(sample_rate_);
+  spec.compute(audio);
+  return detect(spec);
+}
+
+std::vector<SyncCandidate>
+SyncDetector::detect(const Spectrogram &spec) const {
+  return detect(spec, -INFINITY, INFINITY);
+}
+
+std::vector<SyncCandidate> SyncDetector::detect(const Spectrogram &spec,
+                                                float low_hz,
+                                                float high_hz) const {
   std::vector<SyncCandidate> candidates;
-  if (frame.size() < static_cast<size_t>(symbol_len_ * 7))
+  const int osr = spec.time_osr();
+  const int fosr = spec.freq_osr();
+  const int steps = spec.num_steps();
+  const int bins = spec.num_bins();
+  const int max_bin = bins - 8;
+  if (steps < 7 * osr || max_bin <= 0)
     return candidates;
 
-  const int fft_size = symbol_len_;
-  std::vector<std::complex<float>> tmp(fft_size);
-  std::vector<std::complex<float>> fft_out(fft_size);
-  fftwf_plan plan = fftwf_plan_dft_1d(
-      fft_size, reinterpret_cast<fftwf_complex *>(tmp.data()),
-      reinterpret_cast<fftwf_complex *>(fft_out.data()), FFTW_FORWARD,
-      FFTW_ESTIMATE);
-
-  const int step = symbol_len_ / 2; // 80 ms step
-  const int max_t = static_cast<int>(frame.size()) - fft_size * 7;
-
-  for (int t = 0; t <= max_t; t += step) {
-    // FFT magnitudes for 7 symbols
-    std::vector<std::vector<float>> mags(7, std::vector<float>(fft_size));
-    for (int i = 0; i < 7; ++i) {
-      std::copy(frame.begin() + t + i * fft_size,
-                frame.begin() + t + (i + 1) * fft_size, tmp.begin());
-      fftwf_execute(plan);
-      for (int k = 0; k < fft_size; ++k) {
-        float re = fft_out[k].real();
-        float im = fft_out[k].imag();
-        mags[i][k] = re * re + im * im;
+  // Per-bin noise floor: the median power of each fine bin over the frame.
+  // Each tone bin carries a given signal for an eighth of its symbols at
+  // most, so the median tracks the noise and flattens birdies and filter
+  // slopes before tones are compared.
+  const int rows = fosr * bins;
+  std::vector<float> scratch(bins);
+  std::vector<float> inv_noise(rows);
+  {
+    // Gather columns a block of bins at a time: each row is read in
+    // order and the block's columns stay in cache.
+    constexpr int kBlock = 64;
+    std::vector<float> columns(static_cast<size_t>(kBlock) * steps);
+    for (int sub = 0; sub < fosr; ++sub) {
+      for (int k0 = 0; k0 < bins; k0 += kBlock) {
+        const int n = std::min(kBlock, bins - k0);
+        for (int t = 0; t < steps; ++t) {
+          spec.powers(t, sub, k0, n, scratch.data());
+          for (int k = 0; k < n; ++k)
+            columns[static_cast<size_t>(k) * steps + t] = scratch[k];
+        }
+        for (int k = 0; k < n; ++k) {
+          auto column = columns.begin() + static_cast<size_t>(k) * steps;
+          auto mid = column + steps / 2;
+          std::nth_element(column, mid, column + steps);
+          inv_noise[sub * bins + k0 + k] = *mid > 0.0f ? 1.0f / *mid : 0.0f;
+        }
       }
     }
+  }
+  // Normalized power, and its sum over the 8 tones starting at each bin.
+  // Scoring start step t reads steps [first, first + 6 * osr] of each
+  // Costas block, a window that slides one step per t, so each block keeps
+  // its window in a ring rather than the whole slot being normalized up
+  // front: the working set stays a few rows whatever the storage.
+  const int window = 6 * osr + 1;
+  const size_t row_len = static_cast<size_t>(fosr) * bins;
+  std::vector<float> norm(3 * window * row_len);
+  std::vector<float> tones8(3 * window * row_len);
+  std::vector<int> held(3 * window, -1); // step each ring row holds
+  auto fill = [&](int block, int step) {
+    const size_t slot = static_cast<size_t>(block) * window + step % window;
+    if (held[slot] == step)
+      return slot;
+    held[slot] = step;
+    for (int sub = 0; sub < fosr; ++sub) {
+      const float *in = spec.row(step, sub, scratch.data());
+      const float *inv = &inv_noise[sub * bins];
+      float *q = &norm[slot * row_len + static_cast<size_t>(sub) * bins];
+      float *w = &tones8[slot * row_len + static_cast<size_t>(sub) * bins];
+      for (int k = 0; k < bins; ++k)
+        q[k] = in[k] * inv[k];
+      float acc = 0.0f;
+      for (int k = 0; k < 8; ++k)
+        acc += q[k];
+      for (int k = 0; k < max_bin; ++k) {
+        w[k] = acc;
+        acc += q[k + 8] - q[k];
+      }
+    }
+    return slot;
+  };
 
-    // Evaluate correlation for each frequency bin (0..fs/2)
-    const int max_bin = fft_size / 2 - 8; // leave room for Costas offsets
-    std::vector<float> metric(max_bin);
-    for (int k = 0; k < max_bin; ++k) {
-      float sum = 0.0f;
+  // Score every start step and fine frequency (bin * fosr + sub): the
+  // Costas tone power of every block inside the frame over the mean power
+  // of the other seven tones of the same symbols. Noise scores about 1
+  // wherever it is; a frequency that fits only some of the 21 tones
+  // stays low.
+  const int t_min = static_cast<int>(std::floor(kMinStartSec / spec.step_sec()));
+  const int t_max = std::min(
+      static_cast<int>(std::ceil(kMaxStartSec / spec.step_sec())),
+      steps - 7 * osr);
+  const int span = t_max - t_min + 1;
+  const int width = max_bin * fosr;
+  if (span <= 0)
+    return candidates;
+  // Scores are laid out [step][sub][bin] like the spectrogram, so the
+  // kernel writes adjacent bins.
+  std::vector<float> score(static_cast<size_t>(span) * width, 0.0f);
+  size_t slots[21];
+  const float *sync_rows[21];
+  const float *all_rows[21];
+  for (int t = t_min; t <= t_max; ++t) {
+    int used = 0;
+    for (int b = 0; b < 3; ++b) {
+      const int first = t + kCostasStart[b] * osr;
+      if (first < 0 || first + 6 * osr >= steps)
+        continue;
       for (int i = 0; i < 7; ++i)
-        sum += mags[i][k + kCostasSeq[i]];
-      metric[k] = sum;
+        slots[used++] = fill(b, first + i * osr);
     }
-    float avg = std::accumulate(metric.begin(), metric.end(), 0.0f) /
-                static_cast<float>(metric.size());
-    for (int k = 0; k < max_bin; ++k) {
-      if (metric[k] > avg * 10.0f) { // heuristic threshold
-        SyncCandidate c;
-        c.freq_hz = (static_cast<float>(k) * sample_rate_) / fft_size;
-        c.time_sec = static_cast<float>(t) / sample_rate_;
-        c.metric = metric[k];
-        candidates.push_back(c);
+    if (used == 0)
+      continue;
+    for (int sub = 0; sub < fosr; ++sub) {
+      const size_t offset = static_cast<size_t>(sub) * bins;
+      for (int r = 0; r < used; ++r) {
+        sync_rows[r] = &norm[slots[r] * row_len + offset] +
+                       kFT8_Costas_pattern[r % 7];
+        all_rows[r] = &tones8[slots[r] * row_len + offset];
       }
+      costas_score(sync_rows, all_rows, used, max_bin,
+                   &score[(static_cast<size_t>(t - t_min) * fosr + sub) *
+                          max_bin]);
+    }
+  }
+
+  // Local maxima over the 3x3 neighbourhood above the score threshold.
+  auto at = [&](int t, int f) {
+    return score[(static_cast<size_t>(t) * fosr + f % fosr) * max_bin +
+                 f / fosr];
+  };
+  for (int t = 0; t < span; ++t) {
+    for (int f = 0; f < width; ++f) {
+      float v = at(t, f);
+      if (v < min_score_)
+        continue;
+      bool peak = true;
+      for (int dt = -1; dt <= 1 && peak; ++dt) {
+        for (int df = -1; df <= 1; ++df) {
+          int tt = t + dt;
+          int ff = f + df;
+          if ((dt == 0 && df == 0) || tt < 0 || tt >= span || ff < 0 ||
+              ff >= width)
+            continue;
+          // Ties go to the earlier cell so a flat top yields one peak.
+          float w = at(tt, ff);
+          if (w > v || (w == v && (dt < 0 || (dt == 0 && df < 0)))) {
+            peak = false;
+            break;
+          }
+        }
+      }
+      if (!peak)
+        continue;
+      SyncCandidate c;
+      c.freq_sub = f % fosr;
+      c.bin = f / fosr;
+      c.freq_hz = spec.freq_hz(c.freq_sub, c.bin);
+      if (c.freq_hz < low_hz || c.freq_hz > high_hz)
+        continue;
+      c.time_sec = spec.time_sec(t + t_min);
+      c.metric = v;
+      c.step = t + t_min;
+      candidates.push_back(c);
     }
   }
 
-  fftwf_destroy_plan(plan);
   std::sort(candidates.begin(), candidates.end(),
             [](const SyncCandidate &a, const SyncCandidate &b) {
               return a.metric > b.metric;
             });
-  return candidates;
+
+  // Non-maximum suppression: drop peaks within one symbol and one tone of
+  // a stronger candidate, which are sidelobes of the same signal.
+  std::vector<SyncCandidate> kept;
+  for (const auto &c : candidates) {
+    if (max_candidates_ > 0 && kept.size() >= max_candidates_)
+      break;
+    const int f = c.bin * fosr + c.freq_sub;
+    bool suppressed = std::any_of(
+        kept.begin(), kept.end(), [&](const SyncCandidate &k) {
+          return std::abs(k.step - c.step) <= osr &&
+                 std::abs(k.bin * fosr + k.freq_sub - f) <= fosr;
+        });
+    if (!suppressed)
+      kept.push_back(c);
+  }
+  return kept;
 }
 
 } // namespace hf
-
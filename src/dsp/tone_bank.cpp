@@ -0,0 +1,105 @@
+#include "dsp/tone_bank.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace hf {
+
+namespace {
+constexpr size_t kGroup = 4; // lane blocks sharing one pass over the samples
+constexpr size_t kLanes = ToneBank::kLanes;
+
+// Goertzel recurrence s[n] = x[n] + 2 cos(w) s[n-1] - s[n-2] on real and
+// imaginary parts for G lane blocks. State lives in local arrays so the
+// compiler keeps it in vector registers; the blocks are independent, which
+// hides the latency of the recurrence when several candidates share a bank.
+template <size_t G>
+void run_group(const std::complex<float> *x, int len, const float *coef,
+               float *s1re, float *s1im, float *s2re, float *s2im) {
+  float c[G][kLanes];
+  float ar[G][kLanes] = {}, ai[G][kLanes] = {};
+  float br[G][kLanes] = {}, bi[G][kLanes] = {};
+  for (size_t g = 0; g < G; ++g)
+    std::copy_n(coef + g * kLanes, kLanes, c[g]);
+  for (int n = 0; n < len; ++n) {
+    const float xr = x[n].real();
+    const float xi = x[n].imag();
+    for (size_t g = 0; g < G; ++g) {
+      for (size_t l = 0; l < kLanes; ++l) {
+        float tr = xr + c[g][l] * ar[g][l] - br[g][l];
+        float ti = xi + c[g][l] * ai[g][l] - bi[g][l];
+        br[g][l] = ar[g][l];
+        bi[g][l] = ai[g][l];
+        ar[g][l] = tr;
+        ai[g][l] = ti;
+      }
+    }
+  }
+  for (size_t g = 0; g < G; ++g) {
+    std::copy_n(ar[g], kLanes, s1re + g * kLanes);
+    std::copy_n(ai[g], kLanes, s1im + g * kLanes);
+    std::copy_n(br[g], kLanes, s2re + g * kLanes);
+    std::copy_n(bi[g], kLanes, s2im + g * kLanes);
+  }
+}
+} // namespace
+
+ToneBank::ToneBank(int block_len) : block_len_(std::max(1, block_len)) {}
+
+void ToneBank::set_tones(const std::vector<float> &bins) {
+  num_tones_ = bins.size();
+  size_t padded = (num_tones_ + kLanes - 1) / kLanes * kLanes;
+  coef_.assign(padded, 0.0f);
+  cos_.assign(padded, 0.0f);
+  sin_.assign(padded, 0.0f);
+  for (size_t k = 0; k < num_tones_; ++k) {
+    double w = 2.0 * M_PI * bins[k] / block_len_;
+    cos_[k] = static_cast<float>(std::cos(w));
+    sin_[k] = static_cast<float>(std::sin(w));
+    coef_[k] = 2.0f * cos_[k];
+  }
+  s1re_.resize(padded);
+  s1im_.resize(padded);
+  s2re_.resize(padded);
+  s2im_.resize(padded);
+}
+
+void ToneBank::set_tones(int first_bin, int count) {
+  std::vector<float> bins(std::max(0, count));
+  for (size_t k = 0; k < bins.size(); ++k)
+    bins[k] = static_cast<float>(first_bin + static_cast<int>(k));
+  set_tones(bins);
+}
+
+void ToneBank::energies(const std::complex<float> *x, float *out) {
+  const size_t padded = coef_.size();
+  for (size_t first = 0; first < padded; first += kGroup * kLanes) {
+    const size_t blocks = std::min(kGroup, (padded - first) / kLanes);
+    const float *c = &coef_[first];
+    float *s1r = &s1re_[first], *s1i = &s1im_[first];
+    float *s2r = &s2re_[first], *s2i = &s2im_[first];
+    switch (blocks) {
+    case 1:
+      run_group<1>(x, block_len_, c, s1r, s1i, s2r, s2i);
+      break;
+    case 2:
+      run_group<2>(x, block_len_, c, s1r, s1i, s2r, s2i);
+      break;
+    case 3:
+      run_group<3>(x, block_len_, c, s1r, s1i, s2r, s2i);
+      break;
+    default:
+      run_group<4>(x, block_len_, c, s1r, s1i, s2r, s2i);
+      break;
+    }
+  }
+
+  // X(w) = s[N-1] - exp(-jw) s[N-2], up to a unit phase factor.
+  for (size_t k = 0; k < num_tones_; ++k) {
+    float yr = s1re_[k] - (cos_[k] * s2re_[k] + sin_[k] * s2im_[k]);
+    float yi = s1im_[k] - (cos_[k] * s2im_[k] - sin_[k] * s2re_[k]);
+    out[k] = yr * yr + yi * yi;
+  }
+}
+
+} // namespace hf
@@ -0,0 +1,349 @@
+#include "file_source.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <vector>
+
+namespace hf {
+
+namespace {
+constexpr size_t kChunk = 16384; // input samples per read
+
+bool ends_with(const std::string &s, const std::string &suffix) {
+  return s.size() >= suffix.size() &&
+         s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+uint32_t le32(const uint8_t *p) {
+  return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+uint16_t le16(const uint8_t *p) { return static_cast<uint16_t>(p[0] | (p[1] << 8)); }
+
+// Raw token following "key": in a flat JSON document; quotes are stripped.
+// Enough for the few scalar fields SigMF readers need.
+std::string json_value(const std::string &text, const std::string &key) {
+  const std::string quoted = "\"" + key + "\"";
+  auto pos = text.find(quoted);
+  if (pos == std::string::npos)
+    return "";
+  // After the key: SigMF keys have a colon of their own.
+  pos = text.find(':', pos + quoted.size());
+  if (pos == std::string::npos)
+    return "";
+  pos = text.find_first_not_of(" \t\r\n", pos + 1);
+  if (pos == std::string::npos)
+    return "";
+  if (text[pos] == '"') {
+    auto end = text.find('"', pos + 1);
+    return end == std::string::npos ? "" : text.substr(pos + 1, end - pos - 1);
+  }
+  auto end = text.find_first_of(",} \t\r\n", pos);
+  return text.substr(pos, end - pos);
+}
+
+size_t bytes_per_value(FileSource::Format f) {
+  switch (f) {
+  case FileSource::Format::CU8:
+    return 1;
+  case FileSource::Format::CI16:
+    return 2;
+  default:
+    return 4;
+  }
+}
+} // namespace
+
+FileSource::FileSource(Options opts) : opts_(std::move(opts)) {}
+
+FileSource::~FileSource() {
+  stop();
+  close();
+}
+
+FileSource::Format FileSource::format_from_name(const std::string &name) {
+  if (ends_with(name, ".cu8"))
+    return Format::CU8;
+  if (ends_with(name, ".cf32") || ends_with(name, ".fc32"))
+    return Format::CF32;
+  if (ends_with(name, ".ci16") || ends_with(name, ".cs16"))
+    return Format::CI16;
+  if (ends_with(name, ".wav"))
+    return Format::Wav;
+  if (ends_with(name, ".sigmf-meta") || ends_with(name, ".sigmf-data") ||
+      ends_with(name, ".sigmf"))
+    return Format::SigMF;
+  return Format::Auto;
+}
+
+FileSource::Format FileSource::format_from_string(const std::string &name) {
+  if (name == "cu8")
+    return Format::CU8;
+  if (name == "cf32")
+    return Format::CF32;
+  if (name == "ci16")
+    return Format::CI16;
+  if (name == "wav")
+    return Format::Wav;
+  if (name == "sigmf")
+    return Format::SigMF;
+  return Format::Auto;
+}
+
+bool FileSource::open() {
+  close();
+  Format fmt = opts_.format == Format::Auto ? format_from_name(opts_.path)
+                                            : opts_.format;
+  std::string data_path = opts_.path;
+  data_bytes_left_ = std::numeric_limits<uint64_t>::max();
+  channels_ = 2;
+  input_rate_ = opts_.sample_rate;
+
+  if (fmt == Format::SigMF) {
+    std::string base = opts_.path;
+    for (const char *ext : {".sigmf-meta", ".sigmf-data", ".sigmf"}) {
+      if (ends_with(base, ext)) {
+        base.resize(base.size() - std::strlen(ext));
+        break;
+      }
+    }
+    if (!parse_sigmf(base + ".sigmf-meta"))
+      return false;
+    data_path = base + ".sigmf-data";
+  } else if (fmt == Format::Auto) {
+    std::cerr << "Unknown recording format: " << opts_.path << "\n";
+    return false;
+  } else if (fmt != Format::Wav) {
+    sample_format_ = fmt;
+  }
+
+  file_ = std::fopen(data_path.c_str(), "rb");
+  if (!file_) {
+    std::cerr << "Failed to open recording " << data_path << "\n";
+    return false;
+  }
+  if (fmt == Format::Wav && !parse_wav()) {
+    close();
+    return false;
+  }
+
+  if (input_rate_ == 0 || input_rate_ % kBasebandRate != 0) {
+    std::cerr << "Recording rate " << input_rate_
+              << " Hz is not a multiple of " << kBasebandRate << " Hz\n";
+    close();
+    return false;
+  }
+  ingest_ = std::make_unique<IqIngest>(
+      DecimatorChain::plan(static_cast<int>(input_rate_ / kBasebandRate)),
+      2 * kSlotSamples);
+  return true;
+}
+
+void FileSource::close() {
+  if (file_) {
+    std::fclose(file_);
+    file_ = nullptr;
+  }
+}
+
+bool FileSource::parse_wav() {
+  uint8_t hdr[12];
+  if (std::fread(hdr, 1, sizeof(hdr), file_) != sizeof(hdr) ||
+      std::memcmp(hdr, "RIFF", 4) != 0 || std::memcmp(hdr + 8, "WAVE", 4) != 0) {
+    std::cerr << "Not a RIFF/WAVE file: " << opts_.path << "\n";
+    return false;
+  }
+  bool have_fmt = false;
+  uint8_t chunk[8];
+  while (std::fread(chunk, 1, sizeof(chunk), file_) == sizeof(chunk)) {
+    uint32_t size = le32(chunk + 4);
+    if (std::memcmp(chunk, "fmt ", 4) == 0) {
+      // Known layouts take at most 40 bytes; anything far larger is a
+      // corrupt size, not worth allocating.
+      if (size > 64)
+        break;
+      uint8_t fmt[64] = {};
+      if (std::fread(fmt, 1, size, file_) != size)
+        break;
+      if (size & 1)
+        std::fseek(file_, 1, SEEK_CUR);
+      uint16_t tag = le16(&fmt[0]);
+      channels_ = le16(&fmt[2]);
+      input_rate_ = le32(&fmt[4]);
+      uint16_t bits = le16(&fmt[14]);
+      if (tag == 0xFFFE && size >= 26)
+        tag = le16(&fmt[24]); // WAVE_FORMAT_EXTENSIBLE sub-format
+      if (tag == 1 && bits == 16)
+        sample_format_ = Format::CI16;
+      else if (tag == 1 && bits == 8)
+        sample_format_ = Format::CU8;
+      else if (tag == 3 && bits == 32)
+        sample_format_ = Format::CF32;
+      else
+        break;
+      have_fmt = channels_ == 1 || channels_ == 2;
+    } else if (std::memcmp(chunk, "data", 4) == 0) {
+      if (!have_fmt)
+        break;
+      data_bytes_left_ = size;
+      return true;
+    } else {
+      std::fseek(file_, size + (size & 1), SEEK_CUR);
+    }
+  }
+  std::cerr << "Unsupported WAV layout (need 8/16-bit PCM or 32-bit float, "
+               "1 or 2 channels): "
+            << opts_.path << "\n";
+  return false;
+}
+
+bool FileSource::parse_sigmf(const std::string &meta_path) {
+  std::ifstream in(meta_path);
+  if (!in.is_open()) {
+    std::cerr << "Failed to open SigMF metadata " << meta_path << "\n";
+    return false;
+  }
+  std::stringstream ss;
+  ss << in.rdbuf();
+  std::string meta = ss.str();
+  std::string type = json_value(meta, "core:datatype");
+  std::string rate = json_value(meta, "core:sample_rate");
+  if (!rate.empty()) {
+    char *end = nullptr;
+    const double hz = std::strtod(rate.c_str(), &end);
+    if (end != rate.c_str() + rate.size() || !std::isfinite(hz) || hz < 1.0 ||
+        hz > std::numeric_limits<uint32_t>::max()) {
+      std::cerr << "Bad SigMF sample rate '" << rate << "'\n";
+      return false;
+    }
+    input_rate_ = static_cast<uint32_t>(hz);
+  }
+
+  channels_ = (!type.empty() && type[0] == 'r') ? 1 : 2;
+  std::string base = type.size() > 1 ? type.substr(1) : "";
+  if (base == "u8")
+    sample_format_ = Format::CU8;
+  else if (base == "i16_le")
+    sample_format_ = Format::CI16;
+  else if (base == "f32_le")
+    sample_format_ = Format::CF32;
+  else {
+    std::cerr << "Unsupported SigMF datatype '" << type << "'\n";
+    return false;
+  }
+  return true;
+}
+
+bool FileSource::start() {
+  if (!file_ || !ingest_ || running_)
+    return false;
+  running_ = true;
+  finished_ = false;
+  worker_ = std::thread([this]() { run(); });
+  return true;
+}
+
+void FileSource::stop() {
+  if (running_) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      running_ = false;
+    }
+    cv_.notify_all();
+    if (worker_.joinable())
+      worker_.join();
+  }
+}
+
+size_t FileSource::read_chunk(std::complex<float> *out, size_t max_samples) {
+  const size_t value_bytes = bytes_per_value(sample_format_);
+  const size_t frame_bytes = value_bytes * channels_;
+  size_t want = std::min<uint64_t>(max_samples, data_bytes_left_ / frame_bytes);
+  raw_.resize(want * frame_bytes);
+  size_t got = std::fread(raw_.data(), frame_bytes, want, file_);
+  data_bytes_left_ -= got * frame_bytes;
+
+  auto value = [&](size_t i) -> float {
+    const uint8_t *p = &raw_[i * value_bytes];
+    switch (sample_format_) {
+    case Format::CU8:
+      return (p[0] - 127.5f) / 127.5f;
+    case Format::CI16:
+      return static_cast<int16_t>(le16(p)) / 32768.0f;
+    default: {
+      uint32_t bits = le32(p);
+      float f;
+      std::memcpy(&f, &bits, sizeof(f));
+      return f;
+    }
+    }
+  };
+  for (size_t i = 0; i < got; ++i) {
+    if (channels_ == 2)
+      out[i] = {value(2 * i), value(2 * i + 1)};
+    else
+      out[i] = {value(i), 0.0f};
+  }
+  return got;
+}
+
+void FileSource::run() {
+  std::vector<std::complex<float>> iq(kChunk);
+  const uint64_t capacity = ingest_->ring().capacity();
+  const auto t0 = std::chrono::steady_clock::now();
+  uint64_t consumed = 0;
+  while (running_) {
+    size_t n = read_chunk(iq.data(), iq.size());
+    if (n == 0)
+      break;
+    if (opts_.realtime) {
+      std::this_thread::sleep_until(
+          t0 + std::chrono::microseconds(consumed * 1000000 / input_rate_));
+    } else {
+      // Do not overwrite samples the consumer has not released yet.
+      uint64_t out_max = n / ingest_->decimation() + 4;
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [&] {
+        return !running_ || ingest_->head() + out_max <= released_ + capacity;
+      });
+    }
+    ingest_->push(iq.data(), n);
+    consumed += n;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+    }
+    cv_.notify_all();
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    finished_ = true;
+  }
+  cv_.notify_all();
+}
+
+bool FileSource::wait_for(uint64_t seq) {
+  if (!ingest_)
+    return false;
+  std::unique_lock<std::mutex> lock(mutex_);
+  cv_.wait(lock, [&] {
+    return ingest_->head() >= seq || finished_ || !running_;
+  });
+  return ingest_->head() >= seq;
+}
+
+void FileSource::release(uint64_t seq) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    released_ = std::max(released_, seq);
+  }
+  cv_.notify_all();
+}
+
+} // namespace hf
@@ -0,0 +1,94 @@
+#include "iq_ingest.hpp"
+
+#include <algorithm>
+#include <array>
+
+namespace hf {
+
+namespace {
+const std::array<float, 256> kU8ToFloat = [] {
+  std::array<float, 256> lut{};
+  for (int v = 0; v < 256; ++v)
+    lut[v] = (v - 127.5f) / 127.5f;
+  return lut;
+}();
+} // namespace
+
+IqIngest::IqIngest(const std::vector<DecimatorChain::Stage> &stages,
+                   size_t ring_capacity, size_t num_channels)
+    : channelizer_(stages,
+                   std::max<size_t>(1, std::min(num_channels, kMaxChannels))),
+      iq_(kChunk) {
+  for (size_t ch = 0; ch < channelizer_.num_channels(); ++ch) {
+    rings_.push_back(
+        std::make_unique<SpscRing<std::complex<float>>>(ring_capacity));
+    down_.emplace_back(channelizer_.max_output(kChunk));
+    down_ptrs_.push_back(down_.back().data());
+  }
+  for (auto &p : pending_)
+    p.store(0.0, std::memory_order_relaxed);
+}
+
+void IqIngest::set_channel_offset(size_t ch, double offset) {
+  if (ch >= rings_.size())
+    return;
+  pending_[ch].store(offset, std::memory_order_relaxed);
+  pending_gen_.fetch_add(1, std::memory_order_release);
+}
+
+void IqIngest::apply_offsets() {
+  uint32_t gen = pending_gen_.load(std::memory_order_acquire);
+  if (gen == applied_gen_)
+    return;
+  applied_gen_ = gen;
+  for (size_t ch = 0; ch < rings_.size(); ++ch) {
+    double off = pending_[ch].load(std::memory_order_relaxed);
+    if (off != channelizer_.offset(ch))
+      channelizer_.set_offset(ch, off);
+  }
+}
+
+void IqIngest::emit(const std::complex<float> *in, size_t n) {
+  size_t produced = channelizer_.process(in, n, down_ptrs_.data());
+  for (size_t ch = 0; ch < rings_.size(); ++ch)
+    rings_[ch]->write(down_[ch].data(), produced);
+}
+
+void IqIngest::push_u8(const uint8_t *buf, size_t len) {
+  apply_offsets();
+  size_t pairs = len / 2;
+  while (pairs > 0) {
+    size_t n = std::min(pairs, kChunk);
+    for (size_t i = 0; i < n; ++i)
+      iq_[i] = {kU8ToFloat[buf[2 * i]], kU8ToFloat[buf[2 * i + 1]]};
+    emit(iq_.data(), n);
+    buf += 2 * n;
+    pairs -= n;
+  }
+}
+
+void IqIngest::push(const std::complex<float> *in, size_t n) {
+  apply_offsets();
+  while (n > 0) {
+    size_t chunk = std::min(n, kChunk);
+    emit(in, chunk);
+    in += chunk;
+    n -= chunk;
+  }
+}
+
+size_t IqIngest::snapshot(std::complex<float> *out, size_t n,
+                          size_t ch) const {
+  const auto &ring = *rings_[ch];
+  n = std::min(n, ring.capacity());
+  uint64_t head = this->head();
+  // Until n samples have been captured the front of the frame stays silent.
+  size_t avail = static_cast<size_t>(std::min<uint64_t>(head, n));
+  size_t pad = n - avail;
+  std::fill(out, out + pad, std::complex<float>{0.0f, 0.0f});
+  size_t lost = ring.read(head - avail, out + pad, avail);
+  std::fill(out + pad, out + pad + lost, std::complex<float>{0.0f, 0.0f});
+  return lost;
+}
+
+} // namespace hf
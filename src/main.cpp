@@ -1,15 +1,24 @@
 #include "rf_input.hpp"
+#include "file_source.hpp"
 #include "dsp/engine.hpp"
+#include "dsp/fft_plan.hpp"
 #include "data_store.hpp"
 #include "web_server.hpp"
 #include "thread_safe_queue.hpp"
+#include "frame_pool.hpp"
+#include "slot_scheduler.hpp"
 #include "config.hpp"
 #include "logging.hpp"
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <csignal>
 #include <ctime>
 #include <iostream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <optional>
 #include <thread>
 #include <vector>
 
@@ -25,8 +34,57 @@ int main() {
   auto cfg = hf::Config::load("hfdecoder.conf");
   hf::log::init(hf::log::level_from_string(cfg.log_level));
 
-  hf::RfInput rf;
-  hf::DecodeEngine engine(/*sample_rate=*/12000, /*enable_js8=*/true);
+  // Live RTL-SDR capture by default; a recording can be replayed instead.
+  std::unique_ptr<hf::SampleSource> source;
+  if (cfg.source == "file") {
+    hf::FileSource::Options opts;
+    opts.path = cfg.replay_path;
+    opts.format = hf::FileSource::format_from_string(cfg.replay_format);
+    opts.sample_rate = cfg.replay_sample_rate;
+    opts.realtime = cfg.replay_realtime;
+    auto file = std::make_unique<hf::FileSource>(opts);
+    if (!file->open()) {
+      hf::log::error("Failed to open recording " + cfg.replay_path);
+      return 1;
+    }
+    source = std::move(file);
+  } else {
+    source = std::make_unique<hf::RfInput>();
+  }
+
+  hf::FftPlans::set_rigor(hf::FftPlans::rigor_from_string(cfg.fft_planner));
+  if (!cfg.fft_wisdom_path.empty() &&
+      !hf::FftPlans::load_wisdom(cfg.fft_wisdom_path))
+    hf::log::info("No FFTW wisdom at " + cfg.fft_wisdom_path +
+                  ", planning from scratch");
+  hf::DecodeEngine engine(/*sample_rate=*/12000, /*enable_js8=*/true,
+                          cfg.spectrogram_time_osr,
+                          cfg.spectrogram_freq_osr,
+                          static_cast<size_t>(std::max(0, cfg.decode_threads)));
+  if (!engine.set_decode_rate(cfg.decode_rate))
+    hf::log::warn("decode_rate " + std::to_string(cfg.decode_rate) +
+                  " Hz does not divide 12000 Hz, decoding at 12000 Hz");
+  engine.set_spectrogram_storage(
+      hf::Spectrogram::storage_from_string(cfg.spectrogram_storage));
+  engine.set_early_passes(cfg.early_decode_sec);
+  engine.set_max_candidates(
+      static_cast<size_t>(std::max(0, cfg.sync_max_candidates)));
+  engine.set_min_sync_score(cfg.sync_min_score);
+  engine.set_ldpc_algorithm(
+      hf::LDPCDecoder::algorithm_from_string(cfg.ldpc_decoder));
+  hf::LdpcLimits ldpc_limits;
+  ldpc_limits.max_iters = cfg.ldpc_max_iters;
+  ldpc_limits.stall_iters = cfg.ldpc_stall_iters;
+  ldpc_limits.hopeless_iter = cfg.ldpc_hopeless_iter;
+  ldpc_limits.hopeless_errors = cfg.ldpc_hopeless_errors;
+  engine.set_ldpc_limits(ldpc_limits);
+  engine.set_osd_depth(cfg.osd_depth);
+  engine.set_subtraction_passes(cfg.subtract_passes);
+  engine.set_time_budget(cfg.decode_budget_sec);
+  engine.prepare_plans(cfg.decode_input == "usb");
+  if (!cfg.fft_wisdom_path.empty() &&
+      !hf::FftPlans::save_wisdom(cfg.fft_wisdom_path))
+    hf::log::warn("Failed to save FFTW wisdom to " + cfg.fft_wisdom_path);
   hf::DataStore db(cfg.db_path);
   if (!db.open() || !db.init()) {
     hf::log::error("Failed to open database");
@@ -35,9 +93,12 @@ int main() {
 
   hf::log::info("HF FT8/JS8 Decoder starting");
   hf::log::info("Available band presets:");
-  for (const auto &p : rf.presets()) {
-    hf::log::info(std::string(" - ") + p.name + " (" +
-                  std::to_string(p.center_freq_hz) + " Hz)");
+  for (const auto &p : source->presets()) {
+    std::string line = std::string(" - ") + p.name + " (" +
+                       std::to_string(p.center_freq_hz) + " Hz)";
+    for (const auto &c : p.channels)
+      line += std::string(", ") + c.label;
+    hf::log::info(line);
   }
 
   std::atomic<bool> running{true};
@@ -45,7 +106,43 @@ int main() {
   std::atomic<std::time_t> last_capture{0};
   std::atomic<std::time_t> last_decode{0};
   std::atomic<size_t> last_decode_count{0};
-  hf::ThreadSafeQueue<std::vector<std::complex<float>>> decode_queue;
+  std::atomic<long> last_trigger_late_ms{0};
+  // One frame per channel and hand-over, holding the samples captured
+  // since the last one; each carries the band label it was captured under
+  // so a retune mid-queue does not mislabel decodes.
+  struct ChannelFrame {
+    hf::FramePool::Handle frame;
+    const char *band{};
+    uint64_t slot_seq{}; // identifies the slot across its passes
+    size_t channel{};
+    size_t offset{};     // slot sample at the front of frame
+    size_t samples{};    // slot samples captured so far, the end of frame
+    bool final{true};
+    bool decode{true};   // false: only extend the spectrogram
+    std::pair<float, float> passband_hz; // of the band it was captured on
+  };
+  // Audio passband of the current band preset.
+  auto passband = [&]() {
+    const auto &presets = source->presets();
+    if (source->current_band() < presets.size()) {
+      auto it = cfg.band_passband_hz.find(
+          presets[source->current_band()].name);
+      if (it != cfg.band_passband_hz.end())
+        return it->second;
+    }
+    return cfg.passband_hz;
+  };
+  // Slot buffers are preallocated; a slot is dropped if all are in flight.
+  // Stream updates leave a pass's worth of buffers free for decode passes.
+  const size_t passes = engine.early_passes().size() + 1;
+  const size_t reserved = passes * source->num_channels();
+  const size_t frames =
+      std::max<size_t>(4, 2 * passes) * source->num_channels();
+  hf::FramePool frame_pool(frames, hf::SampleSource::kSlotSamples);
+  // Every queued item holds a pool buffer, so the queue never outgrows
+  // the pool and handing a slot over does not allocate.
+  hf::ThreadSafeQueue<ChannelFrame> decode_queue;
+  decode_queue.reserve(frames);
   hf::ThreadSafeQueue<std::vector<hf::DbRecord>> log_queue;
 
   // Handle SIGINT for graceful shutdown.
@@ -61,53 +158,244 @@ int main() {
 
   // Web server runs in its own thread using CivetWeb's internal loop.
   std::thread server_thread([&]() {
-    hf::WebServer server(db, rf, engine, last_capture, last_decode,
-                         last_decode_count, "docs/web", cfg.web_port);
+    hf::WebServer server(db, *source, engine, last_capture, last_decode,
+                         last_decode_count, last_trigger_late_ms, "docs/web",
+                         cfg.web_port);
     while (running) {
       std::this_thread::sleep_for(std::chrono::seconds(1));
     }
   });
 
-  // Attempt to open RTL-SDR; okay if not present during development.
-  if (!rf.open()) {
-    hf::log::warn("RTL-SDR device not found");
-  } else {
-    rf.start();
+  if (auto *rf = dynamic_cast<hf::RfInput *>(source.get())) {
+    // Attempt to open RTL-SDR; okay if not present during development.
+    if (!rf->open())
+      hf::log::warn("RTL-SDR device not found");
   }
+  source->start();
+  const auto started = std::chrono::steady_clock::now();
+  auto last_done = started; // written by the decoder thread only
+  size_t slots_decoded = 0;
 
-  // Capture thread snapshots the latest 15 s frame for decoding.
+  // Capture thread hands each 15 s slot to the decoder as soon as the
+  // source has produced it; live slots are aligned to UTC periods and also
+  // handed over part-way through for the engine's early passes.
+  hf::SlotScheduler scheduler(*source,
+                              std::chrono::milliseconds(cfg.slot_wake_offset_ms),
+                              engine.early_passes(),
+                              std::chrono::milliseconds(
+                                  cfg.spectrogram_stream_ms));
   std::thread capture([&]() {
+    hf::SlotScheduler::Slot next;
+    // Slot samples handed over so far per channel; the decoder keeps the
+    // rest, so each hand-over only reads what arrived since.
+    uint64_t sent_seq = 0;
+    std::vector<size_t> sent;
     while (running) {
-      auto frame = rf.snapshot();
-      last_capture = std::time(nullptr);
-      hf::log::debug("Captured frame");
-      decode_queue.push(std::move(frame));
-      std::this_thread::sleep_for(std::chrono::seconds(15));
+      if (!scheduler.next(next, running)) {
+        if (source->exhausted()) {
+          hf::log::info("Recording finished");
+          running = false;
+          break;
+        }
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        continue;
+      }
+      if (next.start_seq != sent_seq || sent.empty()) {
+        sent_seq = next.start_seq;
+        sent.assign(source->num_channels(), 0);
+      }
+      if (!next.decode) {
+        // Stream updates are best effort: skip one while the decoder is
+        // behind; the next hand-over carries its samples.
+        for (size_t ch = 0; ch < source->num_channels() && running; ++ch) {
+          if (sent[ch] >= next.samples ||
+              frame_pool.available() <= reserved)
+            continue;
+          auto frame = frame_pool.acquire();
+          if (!frame)
+            continue;
+          source->read(next.start_seq + sent[ch], frame->data(),
+                       next.samples - sent[ch], ch);
+          decode_queue.push({std::move(frame), source->channel_label(ch),
+                             next.start_seq, ch, sent[ch], next.samples,
+                             false, false, passband()});
+          sent[ch] = next.samples;
+        }
+        continue;
+      }
+      if (source->clocked()) {
+        last_trigger_late_ms = static_cast<long>(next.late_sec * 1000.0);
+        char utc[16];
+        std::strftime(utc, sizeof(utc), "%H:%M:%S", std::gmtime(&next.utc));
+        std::string msg = std::string("Slot ") + utc + " handed over " +
+                          std::to_string(last_trigger_late_ms.load()) +
+                          " ms after wake";
+        if (next.late_sec > 1.0)
+          hf::log::warn(msg);
+        else
+          hf::log::debug(msg);
+      }
+      size_t ch = 0;
+      for (; ch < source->num_channels() && running; ++ch) {
+        auto frame = frame_pool.acquire();
+        while (!frame && !source->realtime() && running) {
+          // Replay runs at decoder speed; wait for a buffer instead.
+          std::this_thread::sleep_for(std::chrono::milliseconds(5));
+          frame = frame_pool.acquire();
+        }
+        if (!frame) {
+          hf::log::warn(next.final ? "Decoder behind, dropping slot"
+                                   : "Decoder behind, skipping early pass");
+          break;
+        }
+        const size_t from = std::min(sent[ch], next.samples);
+        size_t lost = source->read(next.start_seq + from, frame->data(),
+                                   next.samples - from, ch);
+        if (lost > 0)
+          hf::log::warn("Capture lost " + std::to_string(lost) +
+                        " samples in this frame");
+        decode_queue.push({std::move(frame), source->channel_label(ch),
+                           next.start_seq, ch, from, next.samples, next.final,
+                           true, passband()});
+        sent[ch] = next.samples;
+      }
+      source->release(next.start_seq + next.samples);
+      if (ch > 0) {
+        last_capture = std::time(nullptr);
+        hf::log::debug("Captured frame");
+      }
     }
   });
 
   // Decoder thread processes frames from the capture queue.
   std::thread decoder([&]() {
-    std::vector<std::complex<float>> frame;
-    while (decode_queue.pop(frame)) {
-      auto results = engine.process(frame);
+    // Per-slot state lets each pass build on the ones before it.
+    struct Slot {
+      hf::DecodeEngine::SlotState state;
+      std::vector<std::complex<float>> iq; // the slot as handed over so far
+      std::optional<hf::UsbDemod> usb;
+      std::vector<float> audio;
+      size_t audio_end{}; // audio is final up to here
+    };
+    std::map<std::pair<uint64_t, size_t>, Slot> slots;
+    const bool usb_input = cfg.decode_input == "usb";
+    // Finished slots go back to a pool with their buffers, so samples,
+    // audio and spectrogram are not reallocated every slot. Two per
+    // channel cover a slot still decoding while the next one streams in.
+    std::vector<Slot> spare(2 * source->num_channels());
+    for (auto &s : spare) {
+      s.iq.reserve(hf::SampleSource::kSlotSamples);
+      if (usb_input)
+        s.audio.reserve(hf::SampleSource::kSlotSamples);
+    }
+    auto retire = [&](decltype(slots)::iterator first,
+                      decltype(slots)::iterator last) {
+      for (auto i = first; i != last; ++i)
+        spare.push_back(std::move(i->second));
+      return slots.erase(first, last);
+    };
+    ChannelFrame item;
+    while (decode_queue.pop(item)) {
+      auto key = std::make_pair(item.slot_seq, item.channel);
+      auto it = slots.find(key);
+      if (it == slots.end()) {
+        // Slots whose final pass was dropped are abandoned.
+        retire(slots.begin(), slots.lower_bound({item.slot_seq, 0}));
+        Slot fresh;
+        if (!spare.empty()) {
+          fresh = std::move(spare.back());
+          spare.pop_back();
+        }
+        engine.begin_slot(item.passband_hz.first, item.passband_hz.second,
+                          fresh.state);
+        fresh.usb.reset();
+        fresh.audio_end = 0;
+        it = slots.emplace(key, std::move(fresh)).first;
+        it->second.iq.assign(item.frame->size(), {0.0f, 0.0f});
+      }
+      auto &slot = it->second;
+      std::copy_n(item.frame->begin(), item.samples - item.offset,
+                  slot.iq.begin() + item.offset);
+      item.frame.reset();
+      std::vector<hf::DecodedSignal> results;
+      if (usb_input) {
+        // Decode the receiver's audio like WSJT-X, on real FFTs. Audio
+        // near the end of what has arrived waits for the samples after it.
+        if (!slot.usb) {
+          slot.usb.emplace(hf::SampleSource::kBasebandRate,
+                           item.passband_hz.first, item.passband_hz.second);
+          slot.audio.assign(slot.iq.size(), 0.0f);
+        }
+        const size_t end =
+            item.final ? item.samples
+                       : item.samples -
+                             std::min(item.samples, slot.usb->half_span());
+        slot.usb->process(slot.iq.data(), item.samples, slot.audio_end, end,
+                          slot.audio.data());
+        slot.audio_end = std::max(slot.audio_end, end);
+        if (!item.decode) {
+          engine.extend(slot.audio, slot.audio_end, slot.state);
+          continue;
+        }
+        results = engine.process(slot.audio, slot.audio_end, item.final,
+                                 slot.state);
+      } else {
+        if (!item.decode) {
+          engine.extend(slot.iq, item.samples, slot.state);
+          continue;
+        }
+        results = engine.process(slot.iq, item.samples, item.final, slot.state);
+      }
+      if (!item.final) {
+        hf::log::debug("Early pass at " +
+                       std::to_string(item.samples /
+                                      hf::SampleSource::kBasebandRate) +
+                       " s produced " + std::to_string(results.size()) +
+                       " messages");
+      } else {
+        const auto &st = slot.state.stats;
+        std::string msg = "Slot had " + std::to_string(st.candidates) +
+                          " candidates, " +
+                          std::to_string(st.residual_passes) +
+                          " residual passes";
+        if (st.skipped > 0 || st.reduced > 0) {
+          hf::log::warn(msg + "; over budget: " +
+                        std::to_string(st.reduced) +
+                        " at reduced effort, " + std::to_string(st.skipped) +
+                        " skipped");
+        } else {
+          hf::log::debug(msg);
+        }
+        retire(it, std::next(it));
+        ++slots_decoded;
+      }
+      last_done = std::chrono::steady_clock::now();
       last_decode = std::time(nullptr);
-      last_decode_count = results.size();
-      hf::log::debug("Decoder produced " +
-                     std::to_string(results.size()) + " messages");
+      int iters = 0;
+      for (const auto &r : results)
+        iters += std::max(0, r.ldpc_iterations);
+      // The final pass also returns candidates that failed the CRC; only
+      // messages are stored.
       std::vector<hf::DbRecord> recs;
       recs.reserve(results.size());
       auto now = last_decode.load();
       for (const auto &r : results) {
+        if (!r.crc_ok)
+          continue;
         hf::DbRecord rec{};
         rec.timestamp = now;
-        rec.band = "unknown";
+        rec.band = item.band;
         rec.frequency_hz = r.freq_hz;
         rec.mode = r.mode;
         rec.snr_db = r.snr_db;
         rec.text = r.text;
         recs.push_back(rec);
       }
+      last_decode_count = recs.size();
+      hf::log::debug("Decoder produced " + std::to_string(recs.size()) +
+                     " messages from " + std::to_string(results.size()) +
+                     " candidates in " + std::to_string(iters) +
+                     " LDPC iterations");
       if (!recs.empty()) {
         log_queue.push(std::move(recs));
       }
@@ -126,7 +414,13 @@ int main() {
   logger.join();
   server_thread.join();
 
-  rf.stop();
+  source->stop();
+  if (!source->realtime()) {
+    double sec = std::chrono::duration<double>(last_done - started).count();
+    hf::log::info("Replayed " + std::to_string(slots_decoded) + " slots in " +
+                  std::to_string(sec) + " s (" +
+                  std::to_string(slots_decoded / sec) + " slots/s)");
+  }
   db.close();
   return 0;
 }
@@ -1,5 +1,6 @@
 #include "rf_input.hpp"
 
+#include <algorithm>
 #include <chrono>
 #include <iostream>
 #include <rtl-sdr.h>
@@ -7,12 +8,13 @@
 namespace hf {
 
 RfInput::RfInput() : dev_(nullptr) {
-  presets_ = {{"80m JS8", 3578000u},
-              {"40m FT8", 7074000u},
-              {"40m JS8", 7078000u},
-              {"20m FT8", 14074000u},
-              {"20m JS8", 14078000u}};
-  ring_buffer_.resize(kBasebandRate * 15); // 15 s of 12 kHz complex samples
+  // Tuning sits below the watering holes so the dongle's DC spike stays out
+  // of every channel; each channel is cut from the same 240 kHz capture.
+  presets_ = {{"80m", 3560000u, {{"80m FT8", 3573000u}, {"80m JS8", 3578000u}}},
+              {"40m", 7060000u, {{"40m FT8", 7074000u}, {"40m JS8", 7078000u}}},
+              {"20m", 14060000u,
+               {{"20m FT8", 14074000u}, {"20m JS8", 14078000u}}}};
+  set_band(0);
 }
 
 RfInput::~RfInput() {
@@ -62,8 +64,23 @@ bool RfInput::set_sample_rate(uint32_t rate_hz) {
 bool RfInput::set_band(size_t index) {
   if (index >= presets_.size())
     return false;
+  const auto &band = presets_[index];
+  const double input_rate = static_cast<double>(kBasebandRate) * kDecimation;
+  for (size_t ch = 0; ch < ingest_.num_channels(); ++ch) {
+    double offset = 0.0;
+    if (ch < band.channels.size())
+      offset = (static_cast<double>(band.channels[ch].dial_freq_hz) -
+                band.center_freq_hz) /
+               input_rate;
+    ingest_.set_channel_offset(ch, offset);
+  }
   current_preset_ = index;
-  return set_frequency(presets_[index].center_freq_hz);
+  return set_frequency(band.center_freq_hz);
+}
+
+const char *RfInput::channel_label(size_t ch) const {
+  const auto &band = presets_[current_preset_];
+  return ch < band.channels.size() ? band.channels[ch].label : band.name;
 }
 
 bool RfInput::start() {
@@ -93,46 +110,24 @@ void RfInput::rtlsdr_callback(unsigned char *buf, uint32_t len, void *ctx) {
 }
 
 void RfInput::handle_samples(unsigned char *buf, uint32_t len) {
-  // Down-convert/decimate to ~12 kHz complex baseband and store in ring buffer.
-  std::vector<std::complex<float>> down;
-  down.reserve(len / 2 / kDecimation + 1);
-  std::complex<float> acc{0.0f, 0.0f};
-  uint32_t count = 0;
-  for (uint32_t i = 0; i + 1 < len; i += 2) {
-    float i_val = (static_cast<int>(buf[i]) - 127.5f) / 127.5f;
-    float q_val = (static_cast<int>(buf[i + 1]) - 127.5f) / 127.5f;
-    acc += std::complex<float>(i_val, q_val);
-    if (++count == kDecimation) {
-      down.push_back(acc / static_cast<float>(kDecimation));
-      acc = std::complex<float>{0.0f, 0.0f};
-      count = 0;
-    }
-  }
-
-  // Determine ring buffer position based on NTP-synchronised system clock.
-  auto now = std::chrono::system_clock::now();
-  auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-                now.time_since_epoch())
-                .count();
-  size_t pos = ((ms % 15000) * kBasebandRate) / 1000;
-  pos = (pos + ring_buffer_.size() - down.size()) % ring_buffer_.size();
-
-  std::lock_guard<std::mutex> lock(buffer_mutex_);
-  for (auto &s : down) {
-    ring_buffer_[pos] = s;
-    pos = (pos + 1) % ring_buffer_.size();
-  }
-  ring_pos_ = pos;
+  // The buffer's last sample was taken just before librtlsdr handed it over.
+  auto arrived = std::chrono::system_clock::now();
+  // Low-pass and decimate to ~12 kHz complex baseband and store in ring buffer.
+  ingest_.push_u8(buf, len);
+  stamp(ingest_.head(), arrived);
 }
 
-std::vector<std::complex<float>> RfInput::snapshot() const {
-  std::lock_guard<std::mutex> lock(buffer_mutex_);
-  std::vector<std::complex<float>> out(ring_buffer_.size());
-  size_t pos = ring_pos_;
-  for (size_t i = 0; i < ring_buffer_.size(); ++i) {
-    out[i] = ring_buffer_[(pos + i) % ring_buffer_.size()];
+bool RfInput::wait_for(uint64_t seq) {
+  while (running_) {
+    uint64_t head = ingest_.head();
+    if (head >= seq)
+      return true;
+    // Sleep roughly until the missing samples are due.
+    uint64_t ms = (seq - head) * 1000 / kBasebandRate;
+    ms = std::max<uint64_t>(10, std::min<uint64_t>(ms, 1000));
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
   }
-  return out;
+  return false;
 }
 
 } // namespace hf
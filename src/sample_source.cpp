@@ -0,0 +1,100 @@
+#include "sample_source.hpp"
+
+#include <algorithm>
+
+namespace hf {
+
+const std::vector<BandPreset> &SampleSource::presets() const {
+  static const std::vector<BandPreset> kNone;
+  return kNone;
+}
+
+size_t SampleSource::read(uint64_t start,
+                          std::vector<std::complex<float>> &out,
+                          size_t ch) const {
+  return read(start, out.data(), out.size(), ch);
+}
+
+size_t SampleSource::read(uint64_t start, std::complex<float> *out, size_t n,
+                          size_t ch) const {
+  const auto &ring = ingest().ring(ch);
+  uint64_t head = ingest().head();
+  uint64_t end = start + n;
+  // Samples past the head have not been captured yet.
+  size_t ready = head > start
+                     ? static_cast<size_t>(std::min<uint64_t>(end, head) - start)
+                     : 0;
+  std::fill(out + ready, out + n, std::complex<float>{0.0f, 0.0f});
+  size_t lost = ring.read(start, out, ready);
+  std::fill(out, out + lost, std::complex<float>{0.0f, 0.0f});
+  return lost + (n - ready);
+}
+
+size_t SampleSource::read_usb(uint64_t start, float *out, size_t n,
+                              const UsbDemod &usb, size_t ch) const {
+  const size_t half = usb.half_span();
+  const size_t before = static_cast<size_t>(std::min<uint64_t>(half, start));
+  std::vector<std::complex<float>> iq(before + n + half);
+  // Context either side only primes the filter; losses there do not count.
+  read(start - before, iq.data(), before, ch);
+  size_t lost = read(start, iq.data() + before, n, ch);
+  read(start + n, iq.data() + before + n, half, ch);
+  std::vector<float> audio(iq.size());
+  usb.process(iq.data(), iq.size(), audio.data());
+  std::copy_n(audio.begin() + before, n, out);
+  return lost;
+}
+
+void SampleSource::stamp(uint64_t head,
+                         std::chrono::system_clock::time_point now) {
+  constexpr uint64_t kWindow = 60 * kBasebandRate;
+  int64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       now.time_since_epoch())
+                       .count();
+  // Split into whole seconds so the products cannot overflow.
+  int64_t observed =
+      now_ns - static_cast<int64_t>(head / kBasebandRate * 1000000000ull +
+                                    head % kBasebandRate * 1000000000ull /
+                                        kBasebandRate);
+  int64_t epoch = epoch_ns_.load(std::memory_order_relaxed);
+  if (epoch == 0 || head >= window_end_) {
+    if (epoch != 0)
+      observed = std::min(observed, window_min_ns_);
+    epoch_ns_.store(observed, std::memory_order_release);
+    window_min_ns_ = now_ns; // no sample in the new window yet
+    window_end_ = head + kWindow;
+    return;
+  }
+  window_min_ns_ = std::min(window_min_ns_, observed);
+  // Never let a late anchor stand while an earlier arrival is known.
+  if (observed < epoch)
+    epoch_ns_.store(observed, std::memory_order_release);
+}
+
+bool SampleSource::sample_at(std::chrono::system_clock::time_point t,
+                             int64_t &seq) const {
+  int64_t epoch = epoch_ns_.load(std::memory_order_acquire);
+  if (epoch == 0)
+    return false;
+  int64_t t_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     t.time_since_epoch())
+                     .count();
+  // Round to the nearest sample; split as in stamp() to avoid overflow.
+  int64_t d = t_ns - epoch;
+  seq = d / 1000000000 * kBasebandRate +
+        (d % 1000000000 * kBasebandRate + 500000000) / 1000000000;
+  return true;
+}
+
+size_t SampleSource::snapshot(std::vector<std::complex<float>> &out) const {
+  out.resize(kSlotSamples);
+  return ingest().snapshot(out.data(), out.size());
+}
+
+std::vector<std::complex<float>> SampleSource::snapshot() const {
+  std::vector<std::complex<float>> out;
+  snapshot(out);
+  return out;
+}
+
+} // namespace hf
@@ -0,0 +1,117 @@
+#include "slot_scheduler.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace hf {
+
+SlotScheduler::SlotScheduler(SampleSource &source,
+                             std::chrono::milliseconds wake_offset,
+                             std::vector<float> early_passes,
+                             std::chrono::milliseconds stream_period)
+    : source_(source),
+      wake_offset_(std::max(wake_offset, std::chrono::milliseconds(0))) {
+  for (float t : early_passes)
+    if (t > 0.0f && t < kSlotSec)
+      early_.push_back({t, true});
+  if (stream_period.count() > 0) {
+    // An early pass due at the same time extends the spectrogram anyway.
+    const float period = stream_period.count() / 1000.0f;
+    for (int k = 1; k * period < kSlotSec; ++k) {
+      const float t = k * period;
+      if (std::none_of(early_passes.begin(), early_passes.end(),
+                       [&](float e) { return std::fabs(e - t) < 0.001f; }))
+        early_.push_back({t, false});
+    }
+  }
+  std::sort(early_.begin(), early_.end(),
+            [](const Pass &a, const Pass &b) { return a.sec < b.sec; });
+  pass_ = early_.size() + 1; // no period started yet
+}
+
+std::time_t
+SlotScheduler::next_boundary(std::chrono::system_clock::time_point now,
+                             std::chrono::milliseconds wake_offset,
+                             std::time_t after) {
+  using namespace std::chrono;
+  const int64_t period_ms = kSlotSec * 1000;
+  int64_t t_ms =
+      duration_cast<milliseconds>(now.time_since_epoch() - wake_offset)
+          .count();
+  int64_t end = (t_ms + period_ms - 1) / period_ms * kSlotSec;
+  return std::max<std::time_t>(static_cast<std::time_t>(end),
+                               after + kSlotSec);
+}
+
+bool SlotScheduler::next_unclocked(Slot &slot) {
+  if (!started_) {
+    // Recordings are cut from their first sample while the ring still
+    // holds it, so slots line up with the file however late we start.
+    uint64_t head = source_.ingest().head();
+    next_seq_ = head <= source_.ingest().ring().capacity() ? 0 : head;
+    started_ = true;
+  }
+  uint64_t end = next_seq_ + SampleSource::kSlotSamples;
+  if (!source_.wait_for(end))
+    return false;
+  slot = {next_seq_, 0, 0.0, SampleSource::kSlotSamples, true};
+  next_seq_ = end;
+  return true;
+}
+
+bool SlotScheduler::next(Slot &slot, const std::atomic<bool> &running) {
+  using namespace std::chrono;
+  if (!source_.clocked())
+    return next_unclocked(slot);
+
+  // An early pass or stream update that cannot start within this long of
+  // its offset is skipped; the next hand-over covers its samples.
+  constexpr auto kEarlyGrace = milliseconds(500);
+  while (running) {
+    if (pass_ > early_.size()) {
+      end_ = next_boundary(now_(), wake_offset_, end_);
+      pass_ = 0;
+      start_seq_ = -1;
+    }
+    const size_t pass = pass_++;
+    const bool final = pass == early_.size();
+    const auto start = system_clock::from_time_t(end_ - kSlotSec);
+    const size_t samples =
+        final ? SampleSource::kSlotSamples
+              : static_cast<size_t>(early_[pass].sec *
+                                    SampleSource::kBasebandRate);
+    const auto wake =
+        final ? system_clock::from_time_t(end_) + wake_offset_
+              : start + duration_cast<system_clock::duration>(
+                            duration<float>(early_[pass].sec));
+    if (!final && now_() > wake + kEarlyGrace)
+      continue;
+
+    // Sleep in short steps so shutdown stays prompt.
+    auto now = now_();
+    while (running && (now = now_()) < wake)
+      sleep_(std::min<system_clock::duration>(wake - now, milliseconds(250)));
+    if (!running)
+      return false;
+
+    // Every pass of a period starts at the same sample even if the stream
+    // is re-anchored in between.
+    if (start_seq_ < 0 && !source_.sample_at(start, start_seq_))
+      start_seq_ = -1;
+    if (start_seq_ < 0)
+      continue; // not streaming yet, or the stream began mid-period
+    uint64_t first = static_cast<uint64_t>(start_seq_);
+    if (!source_.wait_for(first + samples))
+      return false;
+    slot.start_seq = first;
+    slot.utc = end_ - kSlotSec;
+    slot.late_sec = duration<double>(now_() - wake).count();
+    slot.samples = samples;
+    slot.final = final;
+    slot.decode = final || early_[pass].decode;
+    return true;
+  }
+  return false;
+}
+
+} // namespace hf
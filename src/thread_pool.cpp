@@ -0,0 +1,102 @@
+#include "thread_pool.hpp"
+
+#include <algorithm>
+
+namespace hf {
+
+ThreadPool::ThreadPool(size_t num_threads) {
+  if (num_threads == 0) {
+    num_threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  for (size_t i = 0; i < num_threads; ++i)
+    queues_.push_back(std::make_unique<Queue>());
+  for (size_t i = 0; i < num_threads; ++i)
+    threads_.emplace_back([this, i]() { worker_loop(i); });
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(wake_mutex_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  for (auto &t : threads_)
+    t.join();
+}
+
+bool ThreadPool::pop(size_t self, Task &task) {
+  auto &q = *queues_[self];
+  std::lock_guard<std::mutex> lock(q.mutex);
+  if (q.tasks.empty())
+    return false;
+  task = q.tasks.back();
+  q.tasks.pop_back();
+  queued_.fetch_sub(1, std::memory_order_relaxed);
+  return true;
+}
+
+bool ThreadPool::steal(size_t self, Task &task) {
+  const size_t n = queues_.size();
+  for (size_t k = 1; k <= n; ++k) {
+    auto &q = *queues_[(self + k) % n];
+    std::lock_guard<std::mutex> lock(q.mutex);
+    if (q.tasks.empty())
+      continue;
+    task = q.tasks.front();
+    q.tasks.pop_front();
+    queued_.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+  }
+  return false;
+}
+
+void ThreadPool::run(const Task &task, size_t worker) {
+  (*task.fn)(task.begin, task.end, worker);
+  // Count and notify under the lock: once parallel_for sees zero it
+  // returns and the Batch on its stack is gone.
+  std::lock_guard<std::mutex> lock(task.batch->mutex);
+  if (--task.batch->pending == 0)
+    task.batch->done.notify_all();
+}
+
+void ThreadPool::worker_loop(size_t self) {
+  Task task;
+  for (;;) {
+    if (pop(self, task) || steal(self, task)) {
+      run(task, self);
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(wake_mutex_);
+    wake_.wait(lock, [&] {
+      return stop_ || queued_.load(std::memory_order_relaxed) > 0;
+    });
+    if (stop_)
+      return;
+  }
+}
+
+void ThreadPool::parallel_for(size_t n, size_t grain, const RangeFn &fn) {
+  if (n == 0)
+    return;
+  grain = std::max<size_t>(1, grain);
+  const size_t chunks = (n + grain - 1) / grain;
+  Batch batch;
+  batch.pending = chunks;
+  size_t q = next_queue_.fetch_add(1, std::memory_order_relaxed);
+  for (size_t begin = 0; begin < n; begin += grain, ++q) {
+    auto &queue = *queues_[q % queues_.size()];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.tasks.push_back({&fn, begin, std::min(n, begin + grain), &batch});
+    queued_.fetch_add(1, std::memory_order_relaxed);
+  }
+  {
+    // Pairs with the predicate check in worker_loop so no wakeup is lost.
+    std::lock_guard<std::mutex> lock(wake_mutex_);
+  }
+  wake_.notify_all();
+
+  std::unique_lock<std::mutex> lock(batch.mutex);
+  batch.done.wait(lock, [&] { return batch.pending == 0; });
+}
+
+} // namespace hf
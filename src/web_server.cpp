@@ -59,15 +59,16 @@ public:
 class StatusHandler : public CivetHandler {
 public:
   StatusHandler(std::atomic<std::time_t> &lc, std::atomic<std::time_t> &ld,
-                std::atomic<size_t> &cnt)
-      : last_capture_(lc), last_decode_(ld), last_count_(cnt) {}
+                std::atomic<size_t> &cnt, std::atomic<long> &late)
+      : last_capture_(lc), last_decode_(ld), last_count_(cnt),
+        last_late_ms_(late) {}
   bool handleGet(CivetServer *, struct mg_connection *conn) override {
     mg_printf(conn,
               "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n"
-              "Connection: close\r\n\r\n{\"last_capture\":%ld,\"last_decode\":%ld,\"last_count\":%zu}",
+              "Connection: close\r\n\r\n{\"last_capture\":%ld,\"last_decode\":%ld,\"last_count\":%zu,\"trigger_late_ms\":%ld}",
               static_cast<long>(last_capture_.load()),
               static_cast<long>(last_decode_.load()),
-              last_count_.load());
+              last_count_.load(), last_late_ms_.load());
     return true;
   }
 
@@ -75,17 +76,21 @@ private:
   std::atomic<std::time_t> &last_capture_;
   std::atomic<std::time_t> &last_decode_;
   std::atomic<size_t> &last_count_;
+  std::atomic<long> &last_late_ms_;
 };
 
 class AudioHandler : public CivetHandler {
 public:
-  explicit AudioHandler(RfInput &rf) : rf_(rf) {}
+  explicit AudioHandler(SampleSource &rf) : rf_(rf) {}
   bool handleGet(CivetServer *, struct mg_connection *conn) override {
-    auto frame = rf_.snapshot();
-    std::vector<int16_t> audio(frame.size());
-    for (size_t i = 0; i < frame.size(); ++i) {
-      float v = frame[i].real();
-      v = std::max(-1.0f, std::min(1.0f, v));
+    // Latest 15 s of the first channel as USB audio.
+    const uint64_t head = rf_.ingest().head();
+    const size_t n = SampleSource::kSlotSamples;
+    std::vector<float> usb(n);
+    rf_.read_usb(head > n ? head - n : 0, usb.data(), n, usb_);
+    std::vector<int16_t> audio(n);
+    for (size_t i = 0; i < n; ++i) {
+      float v = std::max(-1.0f, std::min(1.0f, usb[i]));
       audio[i] = static_cast<int16_t>(v * 32767.0f);
     }
     struct WavHeader {
@@ -116,12 +121,13 @@ public:
   }
 
 private:
-  RfInput &rf_;
+  SampleSource &rf_;
+  UsbDemod usb_;
 };
 
 class BandHandler : public CivetHandler {
 public:
-  explicit BandHandler(RfInput &rf) : rf_(rf) {}
+  explicit BandHandler(SampleSource &rf) : rf_(rf) {}
   bool handleGet(CivetServer *server, struct mg_connection *conn) override {
     auto &presets = rf_.presets();
     std::ostringstream os;
@@ -129,7 +135,14 @@ public:
     for (size_t i = 0; i < presets.size(); ++i) {
       const auto &p = presets[i];
       os << "{\"name\":\"" << p.name << "\",\"freq\":"
-         << p.center_freq_hz << "}";
+         << p.center_freq_hz << ",\"channels\":[";
+      for (size_t c = 0; c < p.channels.size(); ++c) {
+        os << "{\"label\":\"" << p.channels[c].label << "\",\"freq\":"
+           << p.channels[c].dial_freq_hz << "}";
+        if (c + 1 != p.channels.size())
+          os << ",";
+      }
+      os << "]}";
       if (i + 1 != presets.size())
         os << ",";
     }
@@ -160,7 +173,7 @@ public:
   }
 
 private:
-  RfInput &rf_;
+  SampleSource &rf_;
 };
 
 class ModeHandler : public CivetHandler {
@@ -196,10 +209,12 @@ private:
   DecodeEngine &engine_;
 };
 
-WebServer::WebServer(DataStore &db, RfInput &rf, DecodeEngine &engine,
+WebServer::WebServer(DataStore &db, SampleSource &rf,
+                     DecodeEngine &engine,
                      std::atomic<std::time_t> &last_capture,
                      std::atomic<std::time_t> &last_decode,
                      std::atomic<size_t> &last_count,
+                     std::atomic<long> &last_trigger_late_ms,
                      const std::string &doc_root, int port)
     : server_(nullptr), api_handler_(nullptr), sse_handler_(nullptr),
       band_handler_(nullptr), mode_handler_(nullptr),
@@ -212,7 +227,8 @@ WebServer::WebServer(DataStore &db, RfInput &rf, DecodeEngine &engine,
   band_handler_ = std::make_unique<BandHandler>(rf);
   mode_handler_ = std::make_unique<ModeHandler>(engine);
   status_handler_ =
-      std::make_unique<StatusHandler>(last_capture, last_decode, last_count);
+      std::make_unique<StatusHandler>(last_capture, last_decode, last_count,
+                                      last_trigger_late_ms);
   audio_handler_ = std::make_unique<AudioHandler>(rf);
   server_->addHandler("/api/messages", *api_handler_);
   server_->addHandler("/events", *sse_handler_);
@@ -0,0 +1,55 @@
+#pragma once
+// Synthetic FT8 slots for the spectrogram, sync and engine tests.
+#include "dsp/encode.hpp"
+#include <array>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace ft8_test {
+
+struct Signal {
+  float snr_db;   // in 2500 Hz, as WSJT-X reports it
+  float freq_hz;  // tone 0
+  float time_sec; // start of the first symbol into the slot
+  std::array<uint8_t, 10> payload;
+};
+
+// Random free-text message (i3 = n3 = 0), which always unpacks.
+inline std::array<uint8_t, 10> free_text_payload(std::mt19937 &rng) {
+  std::uniform_int_distribution<int> byte(0, 255);
+  std::array<uint8_t, 10> payload{};
+  for (int i = 0; i < 9; ++i)
+    payload[i] = static_cast<uint8_t>(byte(rng));
+  payload[8] &= 0xFE;
+  return payload;
+}
+
+// 15 s complex slot at the given rate: unit-power white noise plus the
+// signals, cut to the slot where they start early or end late.
+inline std::vector<std::complex<float>>
+noisy_slot(const std::vector<Signal> &signals, std::mt19937 &rng,
+           uint32_t sample_rate = 12000) {
+  std::normal_distribution<float> noise(0.0f, std::sqrt(0.5f));
+  std::vector<std::complex<float>> slot(15 * sample_rate);
+  for (auto &x : slot)
+    x = {noise(rng), noise(rng)};
+  hf::FT8Synthesizer synth(sample_rate);
+  std::vector<std::complex<float>> wave(synth.num_samples());
+  for (const auto &s : signals) {
+    synth.synth(hf::ft8_encode(s.payload), s.freq_hz, wave.data());
+    const float amp =
+        std::sqrt(std::pow(10.0f, s.snr_db / 10.0f) * 2500.0f / sample_rate);
+    const long start = std::lround(s.time_sec * sample_rate);
+    for (size_t i = 0; i < wave.size(); ++i) {
+      const long j = start + static_cast<long>(i);
+      if (j >= 0 && j < static_cast<long>(slot.size()))
+        slot[j] += amp * wave[i];
+    }
+  }
+  return slot;
+}
+
+} // namespace ft8_test
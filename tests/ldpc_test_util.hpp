@@ -0,0 +1,59 @@
+#pragma once
+// Shared fixture of the LDPC tests: random FT8 messages sent as BPSK over
+// AWGN.
+#include "dsp/encode.hpp"
+extern "C" {
+#include "ft8/constants.h"
+}
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace ldpc_test {
+
+// 77 random message bits.
+inline std::array<uint8_t, 10> random_payload(std::mt19937 &rng) {
+  std::uniform_int_distribution<int> byte(0, 255);
+  std::array<uint8_t, 10> payload{};
+  for (int i = 0; i < 9; ++i)
+    payload[i] = static_cast<uint8_t>(byte(rng));
+  payload[9] = static_cast<uint8_t>(byte(rng) & 0xF8);
+  return payload;
+}
+
+// Noise standard deviation for unit-amplitude BPSK at the given Eb/N0 with
+// the code rate 91/174.
+inline float ebn0_sigma(float ebn0_db) {
+  const float rate = 91.0f / 174.0f;
+  return std::sqrt(1.0f /
+                   (2.0f * rate * std::pow(10.0f, ebn0_db / 10.0f)));
+}
+
+// LLRs of the 174 codeword bits carrying payload, in the order the demod
+// produces them (> 0 favours 1), clipped to +-25.
+inline std::vector<float> noisy_llrs(const std::array<uint8_t, 10> &payload,
+                                     float ebn0_db, std::mt19937 &rng) {
+  std::normal_distribution<float> noise(0.0f, 1.0f);
+  const float sigma = ebn0_sigma(ebn0_db);
+  int gray_inv[8];
+  for (int v = 0; v < 8; ++v)
+    gray_inv[kFT8_Gray_map[v]] = v;
+  auto tones = hf::ft8_encode(payload);
+  std::vector<float> llrs;
+  for (int s = 0; s < 79; ++s) {
+    if (s < 7 || (s >= 36 && s < 43) || s >= 72)
+      continue; // Costas blocks
+    int v = gray_inv[tones[s]];
+    for (int b = 2; b >= 0; --b) {
+      float y = (((v >> b) & 1) ? 1.0f : -1.0f) + sigma * noise(rng);
+      llrs.push_back(
+          std::max(-25.0f, std::min(25.0f, 2.0f * y / (sigma * sigma))));
+    }
+  }
+  return llrs;
+}
+
+} // namespace ldpc_test
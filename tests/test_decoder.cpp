@@ -1,9 +1,12 @@
 #define CATCH_CONFIG_MAIN
 #include "catch.hpp"
 #include "dsp/decode.hpp"
+#include "dsp/encode.hpp"
 extern "C" {
+#include "ft8/constants.h"
 #include "ft8/crc.h"
 }
+#include <algorithm>
 #include <array>
 #include <fstream>
 #include <vector>
@@ -31,3 +34,63 @@ TEST_CASE("JS8 payload decodes correctly") {
   REQUIRE(hf::decode_js8_payload(payload) == "HELLO");
 }
 
+
+namespace {
+// 174-bit LDPC codeword (91 message + CRC bits, then 83 parity bits).
+std::vector<int> encode_codeword(const std::array<uint8_t,10> &payload) {
+  std::array<uint8_t,12> a91{};
+  ftx_add_crc(payload.data(), a91.data());
+  std::vector<int> bits;
+  for (int i = 0; i < FTX_LDPC_K; ++i)
+    bits.push_back((a91[i / 8] >> (7 - i % 8)) & 1);
+  for (int row = 0; row < FTX_LDPC_M; ++row) {
+    int parity = 0;
+    for (int j = 0; j < FTX_LDPC_K_BYTES; ++j)
+      parity ^= __builtin_parity(a91[j] & kFTX_LDPC_generator[row][j]);
+    bits.push_back(parity);
+  }
+  return bits;
+}
+}
+
+TEST_CASE("Hard tone decisions decode a clean codeword") {
+  auto payload = read_payload("tests/samples/ft8_payload.bin");
+  auto bits = encode_codeword(payload);
+  std::vector<int> tones;
+  size_t bit = 0;
+  for (int s = 0; s < 79; ++s) {
+    if (s < 7 || (s >= 36 && s < 43) || s >= 72) {
+      tones.push_back(kFT8_Costas_pattern[s % 36 % 7]);
+      continue;
+    }
+    int v = bits[bit] << 2 | bits[bit + 1] << 1 | bits[bit + 2];
+    bit += 3;
+    tones.push_back(kFT8_Gray_map[v]);
+  }
+  auto encoded = hf::ft8_encode(payload);
+  REQUIRE(std::equal(tones.begin(), tones.end(), encoded.begin()));
+  hf::LDPCDecoder dec;
+  auto msg = dec.decode(tones, false);
+  REQUIRE(msg.crc_ok);
+  REQUIRE(msg.text == "KA1ABC WA9XYZ EM00");
+}
+
+TEST_CASE("Soft LLRs decode through erasures and weak errors") {
+  auto payload = read_payload("tests/samples/ft8_payload.bin");
+  auto bits = encode_codeword(payload);
+  std::vector<float> llrs;
+  for (size_t i = 0; i < bits.size(); ++i) {
+    float conf = 1.0f + static_cast<float>(i % 5); // varying confidence
+    llrs.push_back(bits[i] ? conf : -conf);
+  }
+  // Erase a run of bits, as a cut-off frame would, and flip a few with
+  // low confidence.
+  for (size_t i = 150; i < 174; ++i)
+    llrs[i] = 0.0f;
+  for (size_t i = 3; i < 140; i += 17)
+    llrs[i] = bits[i] ? -0.3f : 0.3f;
+  hf::LDPCDecoder dec;
+  auto msg = dec.decode(llrs, false);
+  REQUIRE(msg.crc_ok);
+  REQUIRE(msg.text == "KA1ABC WA9XYZ EM00");
+}
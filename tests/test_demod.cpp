@@ -0,0 +1,77 @@
+#include "catch.hpp"
+#include "dsp/demod.hpp"
+#include "dsp/encode.hpp"
+#include "ft8_test_util.hpp"
+extern "C" {
+#include "ft8/constants.h"
+}
+#include <cmath>
+#include <random>
+
+namespace {
+// Hard decisions of the soft bits against the code bits behind the tones.
+int llr_errors(const hf::DemodulatedSignal &d,
+               const std::array<uint8_t, 79> &tones) {
+  int errors = 0;
+  int bit = 0;
+  for (int s = 0; s < 79; ++s) {
+    if (s < 7 || (s >= 36 && s < 43) || s >= 72)
+      continue;
+    int value = 0;
+    while (kFT8_Gray_map[value] != tones[s])
+      ++value;
+    for (int b = 2; b >= 0; --b, ++bit)
+      errors += (d.llrs[bit] > 0.0f) != (((value >> b) & 1) != 0);
+  }
+  return errors;
+}
+} // namespace
+
+TEST_CASE("Demodulating samples refines an off-grid candidate") {
+  // The candidate is a tone high and an eighth of a symbol late; the
+  // Goertzel bank path must land on the signal and read every tone.
+  std::mt19937 rng(11);
+  const auto payload = ft8_test::free_text_payload(rng);
+  auto slot = ft8_test::noisy_slot({{0.0f, 1000.0f, 0.5f, payload}}, rng);
+  hf::SyncCandidate cand{};
+  cand.freq_hz = 1006.25f;
+  cand.time_sec = 0.52f;
+  hf::FSK8Demod demod(12000);
+  auto d = demod.demodulate(slot, cand);
+  REQUIRE(d.freq_hz == Approx(1000.0f));
+  REQUIRE(d.time_sec == Approx(0.5f));
+  const auto tones = hf::ft8_encode(payload);
+  REQUIRE(d.tones == std::vector<int>(tones.begin(), tones.end()));
+  REQUIRE(d.llrs.size() == 174);
+  REQUIRE(llr_errors(d, tones) == 0);
+}
+
+TEST_CASE("Demodulating a candidate too close to the slot end gives nothing") {
+  std::mt19937 rng(12);
+  auto slot = ft8_test::noisy_slot({}, rng);
+  hf::SyncCandidate cand{};
+  cand.freq_hz = 1000.0f;
+  cand.time_sec = 3.0f; // 79 symbols run past 15 s
+  auto d = hf::FSK8Demod(12000).demodulate(slot, cand);
+  REQUIRE(d.tones.empty());
+}
+
+TEST_CASE("Sample and spectrogram demodulation agree") {
+  std::mt19937 rng(13);
+  const auto payload = ft8_test::free_text_payload(rng);
+  auto slot = ft8_test::noisy_slot({{-5.0f, 1500.0f, 0.7f, payload}}, rng);
+  hf::Spectrogram spec(12000);
+  spec.compute(slot);
+  hf::SyncDetector sync(12000);
+  auto cands = sync.detect(spec);
+  REQUIRE_FALSE(cands.empty());
+  hf::FSK8Demod demod(12000);
+  auto from_spec = demod.demodulate(spec, cands.front());
+  auto from_frame = demod.demodulate(slot, cands.front());
+  const auto tones = hf::ft8_encode(payload);
+  const std::vector<int> expected(tones.begin(), tones.end());
+  REQUIRE(from_spec.tones == expected);
+  REQUIRE(from_frame.tones == expected);
+  REQUIRE(from_frame.freq_hz == Approx(from_spec.freq_hz).margin(3.125f));
+  REQUIRE(from_frame.time_sec == Approx(from_spec.time_sec).margin(0.02f));
+}
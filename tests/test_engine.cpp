@@ -0,0 +1,140 @@
+#include "catch.hpp"
+#include "dsp/engine.hpp"
+#include "ft8_test_util.hpp"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+// A few signals well above the decode threshold, spread over the band.
+std::vector<ft8_test::Signal> strong_signals(std::mt19937 &rng) {
+  std::vector<ft8_test::Signal> sigs;
+  for (int i = 0; i < 4; ++i)
+    sigs.push_back({-12.0f + i, 500.0f + 600.0f * i, 0.3f + 0.2f * i,
+                    ft8_test::free_text_payload(rng)});
+  return sigs;
+}
+
+hf::DecodeEngine make_engine() {
+  return hf::DecodeEngine(12000, false, 2, 2, 2);
+}
+
+std::map<std::string, hf::DecodedSignal>
+by_text(const std::vector<hf::DecodedSignal> &decodes) {
+  std::map<std::string, hf::DecodedSignal> out;
+  for (const auto &d : decodes)
+    if (d.crc_ok)
+      out.emplace(d.text, d);
+  return out;
+}
+} // namespace
+
+TEST_CASE("Engine reports each message once across early and final passes") {
+  std::mt19937 rng(4);
+  auto sigs = strong_signals(rng);
+  auto slot = ft8_test::noisy_slot(sigs, rng);
+  auto engine = make_engine();
+  engine.set_early_passes({13.5f});
+  auto state = engine.begin_slot();
+  auto early = engine.process(slot, 13 * 12000 + 6000, false, state);
+  auto final = engine.process(slot, slot.size(), true, state);
+  // Every signal ends before 13.5 s, so the early pass already has them.
+  REQUIRE(by_text(early).size() == sigs.size());
+  std::map<std::string, int> seen;
+  for (const auto *pass : {&early, &final})
+    for (const auto &d : *pass)
+      if (d.crc_ok)
+        ++seen[d.text];
+  REQUIRE(seen.size() >= sigs.size());
+  for (const auto &s : seen)
+    REQUIRE(s.second == 1);
+}
+
+TEST_CASE("Decimated decode matches the full-rate decode") {
+  std::mt19937 rng(5);
+  auto sigs = strong_signals(rng);
+  auto slot = ft8_test::noisy_slot(sigs, rng);
+  auto full = make_engine();
+  auto decimated = make_engine();
+  REQUIRE(decimated.set_decode_rate(4000));
+  REQUIRE_FALSE(decimated.set_decode_rate(5000));
+  REQUIRE(decimated.decode_rate() == 4000);
+  auto a = by_text(full.process(slot));
+  auto b = by_text(decimated.process(slot));
+  REQUIRE(a.size() == sigs.size());
+  REQUIRE(b.size() == a.size());
+  for (const auto &kv : a) {
+    auto it = b.find(kv.first);
+    REQUIRE(it != b.end());
+    REQUIRE(it->second.freq_hz == Approx(kv.second.freq_hz).margin(1.0));
+    REQUIRE(it->second.time_sec == Approx(kv.second.time_sec).margin(0.02));
+  }
+}
+
+TEST_CASE("A restarted slot state decodes like a fresh one") {
+  // The decoder reuses a finished slot's state for the next slot; nothing
+  // of the first slot may leak into the second.
+  std::mt19937 rng(7);
+  auto first = ft8_test::noisy_slot(strong_signals(rng), rng);
+  auto second = ft8_test::noisy_slot(strong_signals(rng), rng);
+  auto engine = make_engine();
+  engine.set_subtraction_passes(1);
+  REQUIRE(engine.set_decode_rate(4000));
+  auto state = engine.begin_slot(200.0f, 3000.0f);
+  engine.process(first, first.size(), true, state);
+  engine.begin_slot(200.0f, 3000.0f, state);
+  auto reused = by_text(engine.process(second, second.size(), true, state));
+  auto fresh_state = engine.begin_slot(200.0f, 3000.0f);
+  auto fresh =
+      by_text(engine.process(second, second.size(), true, fresh_state));
+  REQUIRE(fresh.size() >= 4);
+  REQUIRE(reused.size() == fresh.size());
+  for (const auto &kv : fresh)
+    REQUIRE(reused.count(kv.first) == 1);
+  REQUIRE(state.stats.candidates == fresh_state.stats.candidates);
+}
+
+TEST_CASE("An expired deadline skips every candidate") {
+  std::mt19937 rng(6);
+  auto slot = ft8_test::noisy_slot(strong_signals(rng), rng);
+  auto engine = make_engine();
+  engine.set_subtraction_passes(2);
+  engine.set_time_budget(0.0f);
+  auto state = engine.begin_slot();
+  auto results = engine.process(slot, slot.size(), true, state);
+  REQUIRE(results.empty());
+  REQUIRE(state.stats.candidates > 0);
+  REQUIRE(state.stats.skipped == state.stats.candidates);
+  REQUIRE(state.stats.reduced == 0);
+  REQUIRE(state.stats.residual_passes == 0);
+}
+
+TEST_CASE("A pass running short of time reduces effort, then skips") {
+  // One worker and a clock that ticks a millisecond per reading: each
+  // chunk of candidates appears to take a few milliseconds, so a 12 ms
+  // budget runs out part-way through the candidates.
+  std::mt19937 rng(6);
+  auto slot = ft8_test::noisy_slot(strong_signals(rng), rng);
+  hf::DecodeEngine engine(12000, false, 2, 2, 1);
+  engine.set_subtraction_passes(2);
+  engine.set_osd_depth(2);
+  engine.set_time_budget(0.012f);
+  auto ticks = std::make_shared<int64_t>(0);
+  engine.set_clock([ticks] {
+    return hf::DecodeEngine::Clock::time_point(
+        std::chrono::milliseconds(++*ticks));
+  });
+  auto state = engine.begin_slot();
+  engine.process(slot, slot.size(), true, state);
+  const auto &st = state.stats;
+  CAPTURE(st.candidates, st.reduced, st.skipped);
+  REQUIRE(st.reduced > 0);
+  REQUIRE(st.skipped > 0);
+  REQUIRE(st.reduced + st.skipped < st.candidates);
+  // A cut pass is not followed by residual passes.
+  REQUIRE(st.residual_passes == 0);
+}
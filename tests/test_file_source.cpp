@@ -0,0 +1,137 @@
+#include "catch.hpp"
+#include "file_source.hpp"
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+void put32(std::FILE *f, uint32_t v) {
+  uint8_t b[4] = {uint8_t(v), uint8_t(v >> 8), uint8_t(v >> 16),
+                  uint8_t(v >> 24)};
+  std::fwrite(b, 1, 4, f);
+}
+void put16(std::FILE *f, uint16_t v) {
+  uint8_t b[2] = {uint8_t(v), uint8_t(v >> 8)};
+  std::fwrite(b, 1, 2, f);
+}
+
+// Mono 16-bit PCM WAV at 12 kHz.
+void write_wav(const std::string &path, const std::vector<int16_t> &pcm) {
+  std::FILE *f = std::fopen(path.c_str(), "wb");
+  uint32_t data = static_cast<uint32_t>(pcm.size() * 2);
+  std::fwrite("RIFF", 1, 4, f);
+  put32(f, 36 + data);
+  std::fwrite("WAVEfmt ", 1, 8, f);
+  put32(f, 16);
+  put16(f, 1);
+  put16(f, 1);
+  put32(f, 12000);
+  put32(f, 24000);
+  put16(f, 2);
+  put16(f, 16);
+  std::fwrite("data", 1, 4, f);
+  put32(f, data);
+  for (int16_t v : pcm)
+    put16(f, static_cast<uint16_t>(v));
+  std::fclose(f);
+}
+} // namespace
+
+TEST_CASE("WAV replay delivers every sample to the consumer") {
+  // Two full slots, replayed faster than the ring could hold them at once.
+  const size_t n = 2 * hf::SampleSource::kSlotSamples + 1000;
+  std::vector<int16_t> pcm(n);
+  for (size_t i = 0; i < n; ++i)
+    pcm[i] = static_cast<int16_t>(i % 30000);
+  const std::string path = "file_source_test.wav";
+  write_wav(path, pcm);
+
+  hf::FileSource::Options opts;
+  opts.path = path;
+  hf::FileSource src(opts);
+  REQUIRE(src.open());
+  REQUIRE(src.input_rate() == 12000);
+  REQUIRE(src.start());
+
+  std::vector<std::complex<float>> frame(hf::SampleSource::kSlotSamples);
+  for (uint64_t slot = 1; slot <= 2; ++slot) {
+    uint64_t end = slot * frame.size();
+    REQUIRE(src.wait_for(end));
+    REQUIRE(src.read(end - frame.size(), frame) == 0);
+    src.release(end);
+    size_t i = (slot - 1) * frame.size() + 12345;
+    REQUIRE(frame[12345].real() == Approx(pcm[i] / 32768.0f));
+    REQUIRE(frame[12345].imag() == 0.0f);
+  }
+  REQUIRE_FALSE(src.wait_for(n + 1));
+  REQUIRE(src.exhausted());
+  REQUIRE(src.ingest().head() == n);
+  src.stop();
+  std::remove(path.c_str());
+}
+
+TEST_CASE("WAV with a corrupt fmt chunk size is rejected") {
+  const std::string path = "file_source_bad.wav";
+  std::FILE *f = std::fopen(path.c_str(), "wb");
+  std::fwrite("RIFF", 1, 4, f);
+  put32(f, 36);
+  std::fwrite("WAVEfmt ", 1, 8, f);
+  put32(f, 0xFFFFFFF0u);
+  put16(f, 1);
+  std::fclose(f);
+
+  hf::FileSource::Options opts;
+  opts.path = path;
+  hf::FileSource src(opts);
+  REQUIRE_FALSE(src.open());
+  std::remove(path.c_str());
+}
+
+TEST_CASE("SigMF with a garbage sample rate is rejected") {
+  const std::string base = "file_source_bad";
+  std::FILE *data = std::fopen((base + ".sigmf-data").c_str(), "wb");
+  std::vector<uint8_t> iq(2 * 12000, 128);
+  std::fwrite(iq.data(), 1, iq.size(), data);
+  std::fclose(data);
+  auto opens = [&](const char *rate) {
+    std::FILE *meta = std::fopen((base + ".sigmf-meta").c_str(), "wb");
+    std::fprintf(meta,
+                 "{\"global\": {\"core:datatype\": \"cu8\", "
+                 "\"core:sample_rate\": %s}}",
+                 rate);
+    std::fclose(meta);
+    hf::FileSource::Options opts;
+    opts.path = base + ".sigmf-meta";
+    hf::FileSource src(opts);
+    return src.open();
+  };
+  REQUIRE(opens("240000"));
+  for (const char *rate : {"\"fast\"", "1e999", "-240000", "240000x"}) {
+    CAPTURE(rate);
+    REQUIRE_FALSE(opens(rate));
+  }
+  std::remove((base + ".sigmf-data").c_str());
+  std::remove((base + ".sigmf-meta").c_str());
+}
+
+TEST_CASE("Raw cu8 replay is decimated to 12 kHz") {
+  const std::string path = "file_source_test.cu8";
+  std::FILE *f = std::fopen(path.c_str(), "wb");
+  std::vector<uint8_t> iq(2 * 240000, 128);
+  std::fwrite(iq.data(), 1, iq.size(), f);
+  std::fclose(f);
+
+  hf::FileSource::Options opts;
+  opts.path = path;
+  opts.sample_rate = 240000;
+  hf::FileSource src(opts);
+  REQUIRE(src.open());
+  REQUIRE(src.ingest().decimation() == 20);
+  REQUIRE(src.start());
+  REQUIRE(src.wait_for(12000));
+  REQUIRE_FALSE(src.wait_for(12001));
+  src.stop();
+  std::remove(path.c_str());
+}
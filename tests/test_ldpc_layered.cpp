@@ -0,0 +1,54 @@
+#include "catch.hpp"
+#include "dsp/decode.hpp"
+#include "ldpc_test_util.hpp"
+#include <random>
+#include <vector>
+
+TEST_CASE("Layered BP converges in fewer iterations than flooding") {
+  std::mt19937 rng(17);
+  hf::LDPCDecoder flood;
+  hf::LDPCDecoder layered;
+  layered.set_algorithm(hf::LdpcAlgorithm::Layered);
+  int flood_ok = 0, layered_ok = 0, flood_iters = 0, layered_iters = 0;
+  for (int t = 0; t < 200; ++t) {
+    auto payload = ldpc_test::random_payload(rng);
+    auto llrs = ldpc_test::noisy_llrs(payload, 2.5f, rng);
+    auto a = flood.decode(llrs, false);
+    auto b = layered.decode(llrs, false);
+    flood_ok += a.crc_ok && a.payload == payload;
+    layered_ok += b.crc_ok && b.payload == payload;
+    flood_iters += a.ldpc_iterations;
+    layered_iters += b.ldpc_iterations;
+  }
+  REQUIRE(layered_ok >= flood_ok - 2);
+  REQUIRE(layered_iters < flood_iters);
+}
+
+TEST_CASE("Early termination gives up on noise") {
+  std::mt19937 rng(5);
+  std::normal_distribution<float> noise(0.0f, 3.0f);
+  hf::LDPCDecoder dec;
+  hf::LDPCDecoder layered;
+  layered.set_algorithm(hf::LdpcAlgorithm::Layered);
+  for (int t = 0; t < 20; ++t) {
+    std::vector<float> llrs(174);
+    for (auto &l : llrs)
+      l = noise(rng);
+    auto a = dec.decode(llrs, false);
+    auto b = layered.decode(llrs, false);
+    REQUIRE(a.ldpc_iterations < dec.limits().max_iters);
+    REQUIRE(b.ldpc_iterations < dec.limits().max_iters);
+  }
+
+  // With the rules disabled only the cap applies.
+  hf::LdpcLimits cap_only;
+  cap_only.stall_iters = 0;
+  cap_only.hopeless_errors = 0;
+  dec.set_limits(cap_only);
+  std::vector<float> llrs(174);
+  for (auto &l : llrs)
+    l = noise(rng);
+  auto m = dec.decode(llrs, false);
+  REQUIRE_FALSE(m.crc_ok);
+  REQUIRE(m.ldpc_iterations == cap_only.max_iters);
+}
@@ -0,0 +1,52 @@
+#include "catch.hpp"
+#include "dsp/decode.hpp"
+#include "ldpc_test_util.hpp"
+#include <random>
+#include <vector>
+
+// At 1 dB Eb/N0 belief propagation fails on most codewords; OSD must
+// recover a good share of them and never return a wrong message.
+TEST_CASE("OSD recovers codewords belief propagation misses") {
+  std::mt19937 rng(9);
+  hf::LDPCDecoder dec;
+  int bp_ok = 0, osd1_ok = 0, osd2_ok = 0;
+  const int trials = 100;
+  for (int t = 0; t < trials; ++t) {
+    auto payload = ldpc_test::random_payload(rng);
+    auto llrs = ldpc_test::noisy_llrs(payload, 1.0f, rng);
+    auto m = dec.decode(llrs, false);
+    if (m.crc_ok) {
+      REQUIRE(m.payload == payload);
+      ++bp_ok;
+      continue;
+    }
+    auto a = dec.decode_osd(llrs.data(), 1, false);
+    auto b = dec.decode_osd(llrs.data(), 2, false);
+    if (a.crc_ok) {
+      REQUIRE(a.payload == payload);
+      REQUIRE(a.osd_order == 1);
+      ++osd1_ok;
+    }
+    if (b.crc_ok) {
+      REQUIRE(b.payload == payload);
+      ++osd2_ok;
+    }
+  }
+  REQUIRE(osd1_ok > 0);
+  REQUIRE(osd2_ok >= osd1_ok);
+  REQUIRE(osd2_ok >= (trials - bp_ok) / 3);
+}
+
+TEST_CASE("OSD rejects noise and silence") {
+  std::mt19937 rng(4);
+  std::normal_distribution<float> noise(0.0f, 3.0f);
+  hf::LDPCDecoder dec;
+  for (int t = 0; t < 200; ++t) {
+    std::vector<float> llrs(174);
+    for (auto &l : llrs)
+      l = noise(rng);
+    REQUIRE_FALSE(dec.decode_osd(llrs.data(), 2, false).crc_ok);
+  }
+  std::vector<float> silent(174, -0.01f);
+  REQUIRE_FALSE(dec.decode_osd(silent.data(), 2, false).crc_ok);
+}
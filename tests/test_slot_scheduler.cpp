@@ -0,0 +1,138 @@
+#include "catch.hpp"
+#include "slot_scheduler.hpp"
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+namespace {
+using Clock = std::chrono::system_clock;
+
+// Clocked source whose arrival times are supplied by the test.
+class StampedSource : public hf::SampleSource {
+public:
+  bool start() override { return true; }
+  void stop() override {}
+  const hf::IqIngest &ingest() const override { return ingest_; }
+  bool wait_for(uint64_t) override { return true; }
+  bool clocked() const override { return true; }
+  void arrive(uint64_t head, Clock::time_point t) { stamp(head, t); }
+
+private:
+  hf::IqIngest ingest_{{}, 1024};
+};
+
+// Scheduler on a clock that stands still until it sleeps; returns the
+// clock so a test can also jump it.
+std::shared_ptr<Clock::time_point> fake_clock(hf::SlotScheduler &scheduler,
+                                              Clock::time_point start) {
+  auto now = std::make_shared<Clock::time_point>(start);
+  scheduler.set_clock([now] { return *now; },
+                      [now](Clock::duration d) { *now += d; });
+  return now;
+}
+
+// Period starting at a UTC multiple of 15 s, streamed from sample 0.
+const Clock::time_point kPeriod = Clock::from_time_t(1699999995);
+const uint64_t kRate = hf::SampleSource::kBasebandRate;
+} // namespace
+
+TEST_CASE("Slot boundaries follow UTC periods and the wake offset") {
+  using std::chrono::milliseconds;
+  auto at = [](std::time_t sec, int ms) {
+    return Clock::from_time_t(sec) + milliseconds(ms);
+  };
+  REQUIRE(hf::SlotScheduler::next_boundary(at(1000, 200), milliseconds(0), 0) ==
+          1005);
+  // Still inside the wake offset of the 1005 boundary.
+  REQUIRE(hf::SlotScheduler::next_boundary(at(1005, 300), milliseconds(500),
+                                           0) == 1005);
+  REQUIRE(hf::SlotScheduler::next_boundary(at(1005, 300), milliseconds(0),
+                                           0) == 1020);
+  // A boundary already handed out is never repeated.
+  REQUIRE(hf::SlotScheduler::next_boundary(at(1005, 300), milliseconds(500),
+                                           1005) == 1020);
+}
+
+TEST_CASE("Sample times anchor on the earliest buffer arrival") {
+  StampedSource src;
+  int64_t seq = 0;
+  const auto t0 = Clock::from_time_t(1700000000);
+  REQUIRE_FALSE(src.sample_at(t0, seq));
+
+  const uint64_t rate = hf::SampleSource::kBasebandRate;
+  // Buffers arrive 300 ms and then 50 ms after their last sample was taken.
+  src.arrive(5 * rate, t0 + std::chrono::milliseconds(5300));
+  src.arrive(6 * rate, t0 + std::chrono::milliseconds(6050));
+  REQUIRE(src.sample_at(t0 + std::chrono::seconds(10), seq));
+  REQUIRE(seq == static_cast<int64_t>(10 * rate - rate / 20));
+  // A later, slower buffer does not move the anchor.
+  src.arrive(7 * rate, t0 + std::chrono::milliseconds(7400));
+  REQUIRE(src.sample_at(t0 + std::chrono::seconds(10), seq));
+  REQUIRE(seq == static_cast<int64_t>(10 * rate - rate / 20));
+}
+
+TEST_CASE("Scheduler hands over stream updates, early passes, then the slot") {
+  StampedSource src;
+  src.arrive(kRate, kPeriod + std::chrono::seconds(1));
+  // The early pass at 10 s doubles as the stream update due then.
+  hf::SlotScheduler scheduler(src, std::chrono::milliseconds(500),
+                              {10.0f, 13.5f}, std::chrono::milliseconds(5000));
+  fake_clock(scheduler, kPeriod + std::chrono::milliseconds(200));
+  std::atomic<bool> running{true};
+  struct Expected {
+    double sec;
+    bool decode;
+    bool final;
+  };
+  const Expected expected[] = {{5.0, false, false},
+                               {10.0, true, false},
+                               {13.5, true, false},
+                               {15.0, true, true},
+                               {5.0, false, false}};
+  for (int i = 0; i < 5; ++i) {
+    hf::SlotScheduler::Slot slot;
+    REQUIRE(scheduler.next(slot, running));
+    CAPTURE(i);
+    const bool second = i == 4;
+    REQUIRE(slot.start_seq == (second ? 15 * kRate : 0));
+    REQUIRE(slot.utc == Clock::to_time_t(kPeriod) + (second ? 15 : 0));
+    REQUIRE(slot.samples == static_cast<size_t>(expected[i].sec * kRate));
+    REQUIRE(slot.decode == expected[i].decode);
+    REQUIRE(slot.final == expected[i].final);
+    // The clock only moves while the scheduler sleeps, so every hand-over
+    // is exactly on time.
+    REQUIRE(slot.late_sec == Approx(0.0).margin(1e-6));
+  }
+}
+
+TEST_CASE("Scheduler skips early passes it is too late for") {
+  StampedSource src;
+  src.arrive(kRate, kPeriod + std::chrono::seconds(1));
+  hf::SlotScheduler scheduler(src, std::chrono::milliseconds(0),
+                              {5.0f, 10.0f, 13.5f});
+  auto now = fake_clock(scheduler, kPeriod + std::chrono::milliseconds(200));
+  std::atomic<bool> running{true};
+  hf::SlotScheduler::Slot slot;
+  REQUIRE(scheduler.next(slot, running));
+  REQUIRE(slot.samples == 5 * kRate);
+  // Held up 5.3 s: the 10 s pass is 300 ms overdue, within the grace, and
+  // is handed over late.
+  *now = kPeriod + std::chrono::milliseconds(10300);
+  REQUIRE(scheduler.next(slot, running));
+  REQUIRE(slot.samples == 10 * kRate);
+  REQUIRE(slot.late_sec == Approx(0.3).margin(1e-6));
+  // Past the grace the 13.5 s pass is dropped and the full slot is next.
+  *now = kPeriod + std::chrono::milliseconds(14100);
+  REQUIRE(scheduler.next(slot, running));
+  REQUIRE(slot.final);
+  REQUIRE(slot.samples == hf::SampleSource::kSlotSamples);
+  REQUIRE(slot.late_sec == Approx(0.0).margin(1e-6));
+  // Held up past a whole period: it is dropped, and in the current one the
+  // 5 s pass is overdue and the 10 s pass due now.
+  *now = kPeriod + std::chrono::seconds(40);
+  REQUIRE(scheduler.next(slot, running));
+  REQUIRE(slot.utc == Clock::to_time_t(kPeriod) + 30);
+  REQUIRE(slot.start_seq == 30 * kRate);
+  REQUIRE(slot.samples == 10 * kRate);
+  REQUIRE_FALSE(slot.final);
+}
@@ -0,0 +1,45 @@
+#include "catch.hpp"
+#include "dsp/spectrogram.hpp"
+#include "ft8_test_util.hpp"
+#include <random>
+#include <vector>
+
+namespace {
+template <typename T>
+void require_pieces_match(hf::Spectrogram piecewise, hf::Spectrogram whole,
+                          const std::vector<T> &frame) {
+  whole.compute(frame);
+  piecewise.reset(frame.size());
+  // Uneven pieces, some shorter than a step.
+  size_t available = 0;
+  for (size_t piece : {100, 5000, 1, 23000, 9999})
+    piecewise.extend(frame, available += piece);
+  while (available < frame.size())
+    piecewise.extend(frame, available += 1920);
+  REQUIRE(piecewise.num_steps() == whole.num_steps());
+  REQUIRE(piecewise.num_bins() == whole.num_bins());
+  int mismatches = 0;
+  for (int t = 0; t < whole.num_steps(); ++t)
+    for (int sub = 0; sub < whole.freq_osr(); ++sub)
+      for (int k = 0; k < whole.num_bins(); ++k)
+        mismatches += piecewise.power(t, sub, k) != whole.power(t, sub, k);
+  REQUIRE(mismatches == 0);
+}
+} // namespace
+
+TEST_CASE("Spectrogram extended in pieces matches a full compute") {
+  std::mt19937 rng(1);
+  auto slot = ft8_test::noisy_slot(
+      {{-10.0f, 1000.0f, 0.5f, ft8_test::free_text_payload(rng)}}, rng, 4000);
+  SECTION("complex, two-sided") {
+    require_pieces_match(hf::Spectrogram(4000, 4, 2, 1500.0f),
+                         hf::Spectrogram(4000, 4, 2, 1500.0f), slot);
+  }
+  SECTION("real") {
+    std::vector<float> audio(slot.size());
+    for (size_t i = 0; i < slot.size(); ++i)
+      audio[i] = slot[i].real();
+    require_pieces_match(hf::Spectrogram(4000, 2, 2),
+                         hf::Spectrogram(4000, 2, 2), audio);
+  }
+}
@@ -0,0 +1,91 @@
+#include "catch.hpp"
+#include "spsc_ring.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+TEST_CASE("SPSC ring reads wrap around by sequence number") {
+  hf::SpscRing<int> ring(6);
+  REQUIRE(ring.capacity() == 8);
+  std::vector<int> in(13);
+  std::iota(in.begin(), in.end(), 0);
+  ring.write(in.data(), 5);
+  ring.write(in.data() + 5, 8);
+  REQUIRE(ring.head() == 13);
+
+  std::vector<int> out(6);
+  REQUIRE(ring.read(7, out.data(), out.size()) == 0);
+  REQUIRE(out == std::vector<int>({7, 8, 9, 10, 11, 12}));
+}
+
+TEST_CASE("SPSC ring reports overwritten samples") {
+  hf::SpscRing<int> ring(8);
+  std::vector<int> in(20, 1);
+  ring.write(in.data(), in.size());
+  std::vector<int> out(8);
+  // Sequence 10..17 requested but only 12..19 remain in the ring.
+  REQUIRE(ring.read(10, out.data(), out.size()) == 2);
+  REQUIRE(ring.read(12, out.data(), out.size()) == 0);
+}
+
+TEST_CASE("SPSC ring reads stay consistent while the writer laps them") {
+  // The writer stores each item's own sequence number, so every item a
+  // read does not report as overwritten must match its position. The
+  // reader pauses now and then so the writer laps it, and between its
+  // in-order reads probes the items about to be overwritten.
+  constexpr uint64_t kTotal = uint64_t(1) << 22;
+  hf::SpscRing<uint64_t> ring(256);
+  std::thread writer([&] {
+    std::vector<uint64_t> chunk(97);
+    uint64_t seq = 0;
+    for (size_t n = 1; seq < kTotal; n = n % chunk.size() + 1) {
+      n = static_cast<size_t>(std::min<uint64_t>(n, kTotal - seq));
+      for (size_t i = 0; i < n; ++i)
+        chunk[i] = seq + i;
+      ring.write(chunk.data(), n);
+      seq += n;
+    }
+  });
+
+  std::vector<uint64_t> out(64);
+  std::vector<uint64_t> probe(64);
+  uint64_t cursor = 0;
+  uint64_t overwritten = 0;
+  uint64_t valid = 0;
+  uint64_t bad = 0; // items passed as valid that were not
+  for (int reads = 0; cursor < kTotal; ++reads) {
+    const uint64_t head = ring.head();
+    // Also read the oldest items left, the ones the writer is about to
+    // overwrite, where a torn copy is most likely.
+    if (head >= ring.capacity()) {
+      const uint64_t oldest = head - ring.capacity();
+      const size_t lost = ring.read(oldest, probe.data(), probe.size());
+      for (size_t i = lost; i < probe.size(); ++i)
+        bad += probe[i] != oldest + i;
+    }
+    if (head <= cursor) {
+      std::this_thread::yield();
+      continue;
+    }
+    const size_t n =
+        static_cast<size_t>(std::min<uint64_t>(out.size(), head - cursor));
+    const size_t lost = ring.read(cursor, out.data(), n);
+    for (size_t i = lost; i < n; ++i)
+      bad += out[i] != cursor + i;
+    overwritten += lost;
+    valid += n - lost;
+    cursor += n;
+    if (reads % 128 == 0)
+      std::this_thread::sleep_for(std::chrono::microseconds(50));
+  }
+  writer.join();
+
+  CAPTURE(overwritten, valid);
+  REQUIRE(bad == 0);
+  REQUIRE(overwritten + valid == kTotal);
+  REQUIRE(overwritten > 0);
+  REQUIRE(valid > 0);
+}
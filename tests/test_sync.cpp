@@ -0,0 +1,66 @@
+#include "catch.hpp"
+#include "dsp/sync.hpp"
+#include "ft8_test_util.hpp"
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace {
+// Whether a candidate lies within a tone and a quarter symbol of the
+// signal.
+bool found(const std::vector<hf::SyncCandidate> &cands, float freq_hz,
+           float time_sec) {
+  for (const auto &c : cands)
+    if (std::fabs(c.freq_hz - freq_hz) <= 6.25f &&
+        std::fabs(c.time_sec - time_sec) <= 0.04f)
+      return true;
+  return false;
+}
+} // namespace
+
+TEST_CASE("Sync finds a synthesized FT8 signal") {
+  std::mt19937 rng(2);
+  auto slot = ft8_test::noisy_slot(
+      {{-14.0f, 1234.0f, 0.7f, ft8_test::free_text_payload(rng)}}, rng);
+  hf::SyncDetector sync(12000);
+  auto cands = sync.detect(slot);
+  REQUIRE_FALSE(cands.empty());
+  REQUIRE(found(cands, 1234.0f, 0.7f));
+  // Strongest first, and the signal is the strongest thing in the slot.
+  REQUIRE(std::fabs(cands.front().freq_hz - 1234.0f) <= 6.25f);
+}
+
+TEST_CASE("Sync finds a signal whose first Costas block is cut off") {
+  // Started a second before the slot: the first block is missing, the
+  // other two carry the sync.
+  std::mt19937 rng(3);
+  auto slot = ft8_test::noisy_slot(
+      {{-12.0f, 800.0f, -1.0f, ft8_test::free_text_payload(rng)}}, rng);
+  hf::SyncDetector sync(12000);
+  REQUIRE(found(sync.detect(slot), 800.0f, -1.0f));
+}
+
+TEST_CASE("Sync keeps the candidate cap for the band searched") {
+  // More strong signals above the band than the cap allows: unbounded,
+  // they take every slot; with the band given the weak in-band signal is
+  // still found.
+  std::mt19937 rng(4);
+  std::vector<ft8_test::Signal> sigs;
+  for (int i = 0; i < 6; ++i)
+    sigs.push_back({-6.0f, 3300.0f + 300.0f * i, 0.5f,
+                    ft8_test::free_text_payload(rng)});
+  sigs.push_back({-14.0f, 1000.0f, 0.5f, ft8_test::free_text_payload(rng)});
+  auto slot = ft8_test::noisy_slot(sigs, rng);
+  hf::Spectrogram spec(12000);
+  spec.compute(slot);
+  hf::SyncDetector sync(12000);
+  sync.set_max_candidates(4);
+  REQUIRE_FALSE(found(sync.detect(spec), 1000.0f, 0.5f));
+  auto cands = sync.detect(spec, 200.0f, 3000.0f);
+  REQUIRE(cands.size() <= 4);
+  REQUIRE(found(cands, 1000.0f, 0.5f));
+  for (const auto &c : cands) {
+    REQUIRE(c.freq_hz >= 200.0f);
+    REQUIRE(c.freq_hz <= 3000.0f);
+  }
+}
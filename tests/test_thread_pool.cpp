@@ -0,0 +1,38 @@
+#include "catch.hpp"
+#include "thread_pool.hpp"
+#include <atomic>
+#include <vector>
+
+TEST_CASE("Thread pool covers every index exactly once") {
+  hf::ThreadPool pool(4);
+  REQUIRE(pool.size() == 4);
+  const size_t n = 1000;
+  std::vector<std::atomic<int>> hits(n);
+  std::atomic<bool> bad_worker{false};
+  for (int round = 0; round < 3; ++round) {
+    pool.parallel_for(n, 7, [&](size_t begin, size_t end, size_t worker) {
+      if (worker >= pool.size())
+        bad_worker = true;
+      for (size_t i = begin; i < end; ++i)
+        ++hits[i];
+    });
+  }
+  REQUIRE_FALSE(bad_worker);
+  for (size_t i = 0; i < n; ++i)
+    REQUIRE(hits[i] == 3);
+  // An empty range returns immediately.
+  pool.parallel_for(0, 8, [&](size_t, size_t, size_t) { bad_worker = true; });
+  REQUIRE_FALSE(bad_worker);
+}
+
+TEST_CASE("Thread pool survives many tiny batches") {
+  // The batch lives on the caller's stack; the last chunk must be done
+  // with it before parallel_for returns.
+  hf::ThreadPool pool(4);
+  std::atomic<size_t> total{0};
+  for (int round = 0; round < 20000; ++round)
+    pool.parallel_for(3, 1, [&](size_t begin, size_t end, size_t) {
+      total += end - begin;
+    });
+  REQUIRE(total == 60000);
+}